@@ -0,0 +1,53 @@
+#include "allocation_counter.h"
+#include <cstdlib>
+#include <new>
+
+AllocationCounter::Phase AllocationCounter::s_Phase = AllocationCounter::Phase::Startup;
+AllocationCounter::Statistics AllocationCounter::s_Statistics[static_cast<size_t>(Phase::Count)];
+
+void AllocationCounter::Print(std::ostream& os)
+{
+    static const char* const names[] = {"startup", "lex", "parse", "eval"};
+
+    os << "Allocations" << '\n';
+    for (size_t i = 0; i < static_cast<size_t>(Phase::Count); i++)
+    {
+        os << names[i] << ": " << s_Statistics[i].allocations << " allocations, "
+           << s_Statistics[i].bytes << " bytes" << '\n';
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    AllocationCounter::Count(size);
+
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+
+// Counts the heap allocations made through the global operator new,
+// attributed to the phase of the interpreter that is active at the moment.
+class AllocationCounter
+{
+public:
+    enum class Phase
+    {
+        Startup,
+        Lex,
+        Parse,
+        Eval,
+        Count,
+    };
+
+    struct Statistics
+    {
+        size_t allocations = 0;
+        size_t bytes = 0;
+    };
+
+    // Makes the phase active for the lifetime of the scope
+    class Scope
+    {
+    public:
+        explicit Scope(Phase phase)
+            : m_Previous(s_Phase)
+        {
+            s_Phase = phase;
+        }
+
+        ~Scope()
+        {
+            s_Phase = m_Previous;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        Phase m_Previous;
+    };
+
+    static void Count(size_t bytes)
+    {
+        Statistics& stats = s_Statistics[static_cast<size_t>(s_Phase)];
+        stats.allocations++;
+        stats.bytes += bytes;
+    }
+
+    static const Statistics& GetStatistics(Phase phase)
+    {
+        return s_Statistics[static_cast<size_t>(phase)];
+    }
+
+    static void Print(std::ostream& os);
+private:
+    static Phase s_Phase;
+    static Statistics s_Statistics[static_cast<size_t>(Phase::Count)];
+};
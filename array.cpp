@@ -0,0 +1,343 @@
+#include "array.h"
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+namespace Runtime {
+
+namespace {
+
+// Buffers smaller than this come from malloc's own free lists quickly
+constexpr size_t CachedBufferBytes = 64 * 1024;
+constexpr size_t MaxCachedBuffers = 8;
+
+struct CachedBuffer
+{
+    void* data;
+    size_t bytes;
+};
+
+std::vector<CachedBuffer>& GetBufferCache()
+{
+    // Never destroyed, arrays may outlive static destructors
+    static auto* cache = new std::vector<CachedBuffer>();
+    return *cache;
+}
+
+ObjectHolder MakeInt64(int64_t value)
+{
+    if (value >= INT32_MIN && value <= INT32_MAX)
+        return ObjectHolder::Own(Number(static_cast<int>(value)));
+
+    return ObjectHolder::Own(BigInt(BigInteger(static_cast<long long>(value))));
+}
+
+// One side of an element-wise operation, an array or a scalar
+class ElementOperand
+{
+public:
+    explicit ElementOperand(const Object& object)
+    {
+        switch (object.GetTypeTag())
+        {
+        case TypeTag::Array:
+            m_Array = &static_cast<const Array&>(object);
+            break;
+        case TypeTag::Number:
+            m_Int = static_cast<const Number&>(object).GetValue();
+            break;
+        case TypeTag::Float:
+            m_Float = static_cast<const Float&>(object).GetValue();
+            m_IsFloat = true;
+            break;
+        default:
+            throw std::runtime_error("Arrays only combine with arrays, ints and floats");
+        }
+    }
+
+    const Array* GetArray() const
+    {
+        return m_Array;
+    }
+
+    bool HasFloats() const
+    {
+        return m_Array ? m_Array->HasFloats() : m_IsFloat;
+    }
+
+    Kernels::Operand<int64_t> AsInts() const
+    {
+        if (m_Array)
+            return {m_Array->GetInts().data()};
+        return {nullptr, m_Int};
+    }
+
+    Kernels::Operand<double> AsFloats()
+    {
+        if (!m_Array)
+            return {nullptr, m_IsFloat ? m_Float : static_cast<double>(m_Int)};
+
+        if (m_Array->HasFloats())
+            return {m_Array->GetFloats().data()};
+
+        const Array::Ints& ints = m_Array->GetInts();
+        m_Converted.assign(ints.begin(), ints.end());
+        return {m_Converted.data()};
+    }
+private:
+    const Array* m_Array = nullptr;
+    int64_t m_Int = 0;
+    double m_Float = 0;
+    bool m_IsFloat = false;
+    Array::Floats m_Converted;
+};
+
+size_t CommonSize(const ElementOperand& lhs, const ElementOperand& rhs)
+{
+    const Array* left = lhs.GetArray();
+    const Array* right = rhs.GetArray();
+
+    if (left && right && left->Size() != right->Size())
+        throw std::runtime_error("Arrays of different sizes can't be combined");
+
+    return left ? left->Size() : right->Size();
+}
+
+}
+
+void* AllocateArrayBuffer(size_t bytes)
+{
+    if (bytes >= CachedBufferBytes)
+    {
+        std::vector<CachedBuffer>& cache = GetBufferCache();
+        auto it = std::find_if(cache.begin(), cache.end(), [bytes](const CachedBuffer& buffer) {
+            return buffer.bytes == bytes;
+        });
+
+        if (it != cache.end())
+        {
+            void* data = it->data;
+            cache.erase(it);
+            return data;
+        }
+    }
+    return ::operator new(bytes);
+}
+
+void DeallocateArrayBuffer(void* buffer, size_t bytes)
+{
+    std::vector<CachedBuffer>& cache = GetBufferCache();
+    if (bytes < CachedBufferBytes)
+    {
+        ::operator delete(buffer);
+        return;
+    }
+
+    if (cache.size() == MaxCachedBuffers)
+    {
+        ::operator delete(cache.front().data);
+        cache.erase(cache.begin());
+    }
+    cache.push_back({buffer, bytes});
+}
+
+ObjectHolder Array::FromList(const List& list, const std::string& elementType)
+{
+    if (elementType != "int" && elementType != "float")
+        throw std::runtime_error("Unknown array element type " + elementType);
+
+    size_t size = list.Size();
+    bool floats = elementType == "float";
+
+    if (const std::vector<int>* ints = list.TryGetInts())
+    {
+        if (floats)
+            return ObjectHolder::Own(Array(Floats(ints->begin(), ints->end())));
+        return ObjectHolder::Own(Array(Ints(ints->begin(), ints->end())));
+    }
+
+    for (size_t i = 0; i < size && !floats; i++)
+    {
+        floats = Runtime::GetTypeTag(list.Get(i)) == TypeTag::Float;
+    }
+
+    if (floats)
+    {
+        Floats values;
+        values.reserve(size);
+        for (size_t i = 0; i < size; i++)
+        {
+            ObjectHolder item = list.Get(i);
+            if (const Float* value = item.TryAs<Float>())
+                values.push_back(value->GetValue());
+            else if (const Number* number = item.TryAs<Number>())
+                values.push_back(number->GetValue());
+            else
+                throw std::runtime_error("Array elements must be ints or floats");
+        }
+        return ObjectHolder::Own(Array(std::move(values)));
+    }
+
+    Ints values;
+    values.reserve(size);
+    for (size_t i = 0; i < size; i++)
+    {
+        ObjectHolder item = list.Get(i);
+        if (const Number* number = item.TryAs<Number>())
+            values.push_back(number->GetValue());
+        else
+            throw std::runtime_error("Array elements must be ints or floats");
+    }
+    return ObjectHolder::Own(Array(std::move(values)));
+}
+
+size_t Array::Size() const
+{
+    return std::visit([](const auto& items) { return items.size(); }, m_Items);
+}
+
+size_t Array::ToOffset(int index) const
+{
+    size_t size = Size();
+    long long offset = index < 0 ? static_cast<long long>(size) + index : index;
+
+    if (offset < 0 || offset >= static_cast<long long>(size))
+    {
+        throw std::runtime_error("Array index out of range");
+    }
+    return static_cast<size_t>(offset);
+}
+
+ObjectHolder Array::Get(int index) const
+{
+    size_t offset = ToOffset(index);
+    if (HasFloats())
+    {
+        return ObjectHolder::Own(Float(GetFloats()[offset]));
+    }
+    return MakeInt64(GetInts()[offset]);
+}
+
+void Array::Set(int index, const ObjectHolder& value)
+{
+    size_t offset = ToOffset(index);
+    const Number* number = value.TryAs<Number>();
+
+    if (auto* floats = std::get_if<Floats>(&m_Items))
+    {
+        if (const Float* real = value.TryAs<Float>())
+            (*floats)[offset] = real->GetValue();
+        else if (number)
+            (*floats)[offset] = number->GetValue();
+        else
+            throw std::runtime_error("Float arrays only store ints and floats");
+    }
+    else if (number)
+    {
+        std::get<Ints>(m_Items)[offset] = number->GetValue();
+    }
+    else
+    {
+        throw std::runtime_error("Int arrays only store ints");
+    }
+}
+
+ObjectHolder Array::Call(const std::string& method, std::span<const ObjectHolder> actualParams)
+{
+    if (actualParams.empty() && (method == "sum" || method == "min" || method == "max"))
+    {
+        if (method != "sum" && Size() == 0)
+            throw std::runtime_error(method + "() of an empty array");
+
+        if (HasFloats())
+        {
+            const Floats& floats = GetFloats();
+            double result = method == "sum" ? Kernels::Sum(floats.data(), floats.size())
+                : method == "min" ? Kernels::Min(floats.data(), floats.size())
+                : Kernels::Max(floats.data(), floats.size());
+            return ObjectHolder::Own(Float(result));
+        }
+
+        const Ints& ints = GetInts();
+        int64_t result = method == "sum" ? Kernels::Sum(ints.data(), ints.size())
+            : method == "min" ? Kernels::Min(ints.data(), ints.size())
+            : Kernels::Max(ints.data(), ints.size());
+        return MakeInt64(result);
+    }
+
+    if (method == "dot" && actualParams.size() == 1)
+    {
+        const Array* other = actualParams.front().TryAs<Array>();
+        if (!other)
+            throw std::runtime_error("dot() takes an array");
+
+        if (other->Size() != Size())
+            throw std::runtime_error("Arrays of different sizes can't be combined");
+
+        if (!HasFloats() && !other->HasFloats())
+        {
+            return MakeInt64(Kernels::Dot(GetInts().data(), other->GetInts().data(), Size()));
+        }
+
+        ElementOperand lhs(*this);
+        ElementOperand rhs(*other);
+        return ObjectHolder::Own(Float(Kernels::Dot(lhs.AsFloats().data, rhs.AsFloats().data, Size())));
+    }
+
+    throw std::runtime_error("Array has no method " + method + " taking " + std::to_string(actualParams.size()) + " arguments");
+}
+
+void Array::Print(std::ostream& os, Context& context)
+{
+    os << "array([";
+    for (size_t i = 0; i < Size(); i++)
+    {
+        if (i > 0)
+            os << ", ";
+
+        if (HasFloats())
+            PrintFloat(os, GetFloats()[i]);
+        else
+            os << GetInts()[i];
+    }
+    os << "])";
+}
+
+ObjectHolder ApplyElements(Kernels::ElementOp op, const Object& lhs, const Object& rhs)
+{
+    ElementOperand left(lhs);
+    ElementOperand right(rhs);
+    size_t size = CommonSize(left, right);
+
+    if (left.HasFloats() || right.HasFloats())
+    {
+        Array::Floats result(size);
+        Kernels::Apply(op, left.AsFloats(), right.AsFloats(), result.data(), size);
+        return ObjectHolder::Own(Array(std::move(result)));
+    }
+
+    Array::Ints result(size);
+    Kernels::Apply(op, left.AsInts(), right.AsInts(), result.data(), size);
+    return ObjectHolder::Own(Array(std::move(result)));
+}
+
+ObjectHolder CompareElements(CompareOp op, const Object& lhs, const Object& rhs)
+{
+    ElementOperand left(lhs);
+    ElementOperand right(rhs);
+    size_t size = CommonSize(left, right);
+
+    Array::Ints result(size);
+    if (left.HasFloats() || right.HasFloats())
+    {
+        Kernels::Compare(op, left.AsFloats(), right.AsFloats(), result.data(), size);
+    }
+    else
+    {
+        Kernels::Compare(op, left.AsInts(), right.AsInts(), result.data(), size);
+    }
+    return ObjectHolder::Own(Array(std::move(result)));
+}
+
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <variant>
+#include <vector>
+#include "object.h"
+#include "comparators.h"
+#include "array_kernels.h"
+
+namespace Runtime {
+
+// Large element buffers are recycled, so that the temporaries of array
+// expressions don't go back to the system and page fault on every use
+void* AllocateArrayBuffer(size_t bytes);
+void DeallocateArrayBuffer(void* buffer, size_t bytes);
+
+// Allocator of array elements. It leaves the elements of a resized vector
+// uninitialized instead of zeroing them, as the kernels overwrite them.
+template <typename T>
+struct ArrayAllocator
+{
+    using value_type = T;
+
+    ArrayAllocator() = default;
+
+    template <typename U>
+    ArrayAllocator(const ArrayAllocator<U>&)
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(AllocateArrayBuffer(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n)
+    {
+        DeallocateArrayBuffer(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    void construct(U* p) noexcept
+    {
+        ::new (static_cast<void*>(p)) U;
+    }
+
+    template <typename U, typename ...Args>
+    void construct(U* p, Args&& ...args)
+    {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    bool operator==(const ArrayAllocator<U>&) const
+    {
+        return true;
+    }
+};
+
+// Typed numeric array with contiguous int64 or double elements. Arithmetic
+// and comparisons apply to all the elements at once through the SIMD
+// kernels, so a whole batch costs a single AST evaluation. Comparisons
+// produce int arrays with 1 where they hold, which can be summed to count.
+class Array : public Object
+{
+public:
+    using Ints = std::vector<int64_t, ArrayAllocator<int64_t>>;
+    using Floats = std::vector<double, ArrayAllocator<double>>;
+
+    explicit Array(Ints values)
+        : Object(TypeTag::Array), m_Items(std::move(values))
+    {
+    }
+
+    explicit Array(Floats values)
+        : Object(TypeTag::Array), m_Items(std::move(values))
+    {
+    }
+
+    // Converts a list of ints and floats. The array holds floats when the
+    // list has any or when the element type is "float".
+    static ObjectHolder FromList(const List& list, const std::string& elementType);
+
+    size_t Size() const;
+
+    bool HasFloats() const
+    {
+        return std::holds_alternative<Floats>(m_Items);
+    }
+
+    const Ints& GetInts() const
+    {
+        return std::get<Ints>(m_Items);
+    }
+
+    const Floats& GetFloats() const
+    {
+        return std::get<Floats>(m_Items);
+    }
+
+    ObjectHolder Get(int index) const;
+    void Set(int index, const ObjectHolder& value);
+
+    // Built-in methods: sum(), min(), max(), dot(other)
+    ObjectHolder Call(const std::string& method, std::span<const ObjectHolder> actualParams);
+
+    void Print(std::ostream& os, Context& context) override;
+private:
+    size_t ToOffset(int index) const;
+
+    std::variant<Ints, Floats> m_Items;
+};
+
+// Element-wise operations of arrays with arrays of the same size or with
+// int and float scalars. The result holds floats when either operand does.
+ObjectHolder ApplyElements(Kernels::ElementOp op, const Object& lhs, const Object& rhs);
+ObjectHolder CompareElements(CompareOp op, const Object& lhs, const Object& rhs);
+
+template <>
+struct TaggedType<TypeTag::Array>
+{
+    using Type = Array;
+};
+
+template <>
+struct PoolTraits<Array>
+{
+    static constexpr bool Pooled = true;
+    static constexpr const char* Name = "Array";
+    static constexpr size_t BlocksPerChunk = 256;
+};
+
+}
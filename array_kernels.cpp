@@ -0,0 +1,516 @@
+#include "array_kernels.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_AVX2_KERNELS
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+namespace Runtime::Kernels {
+
+namespace {
+
+bool s_Avx2Enabled = true;
+
+template <typename T>
+T Load(const Operand<T>& operand, size_t i)
+{
+    return operand.data ? operand.data[i] : operand.scalar;
+}
+
+int64_t Combine(ElementOp op, int64_t lhs, int64_t rhs)
+{
+    // Unsigned, so that overflow wraps around instead of being undefined
+    uint64_t x = lhs;
+    uint64_t y = rhs;
+    switch (op)
+    {
+    case ElementOp::Add:
+        return x + y;
+    case ElementOp::Sub:
+        return x - y;
+    case ElementOp::Mul:
+        return x * y;
+    }
+    return 0;
+}
+
+double Combine(ElementOp op, double lhs, double rhs)
+{
+    switch (op)
+    {
+    case ElementOp::Add:
+        return lhs + rhs;
+    case ElementOp::Sub:
+        return lhs - rhs;
+    case ElementOp::Mul:
+        return lhs * rhs;
+    }
+    return 0;
+}
+
+template <typename T>
+bool Holds(CompareOp op, T lhs, T rhs)
+{
+    switch (op)
+    {
+    case CompareOp::Less:
+        return lhs < rhs;
+    case CompareOp::LessOrEqual:
+        return lhs <= rhs;
+    case CompareOp::Greater:
+        return lhs > rhs;
+    case CompareOp::GreaterOrEqual:
+        return lhs >= rhs;
+    case CompareOp::Equal:
+        return lhs == rhs;
+    case CompareOp::NotEqual:
+        return lhs != rhs;
+    }
+    return false;
+}
+
+// The scalar versions start where the vectorized ones stopped, so they
+// also process the tails shorter than a vector
+
+template <typename T>
+void ScalarApply(ElementOp op, Operand<T> lhs, Operand<T> rhs, T* out, size_t n, size_t start)
+{
+    for (size_t i = start; i < n; i++)
+    {
+        out[i] = Combine(op, Load(lhs, i), Load(rhs, i));
+    }
+}
+
+template <typename T>
+void ScalarCompare(CompareOp op, Operand<T> lhs, Operand<T> rhs, int64_t* out, size_t n, size_t start)
+{
+    for (size_t i = start; i < n; i++)
+    {
+        out[i] = Holds(op, Load(lhs, i), Load(rhs, i));
+    }
+}
+
+#ifdef HAVE_AVX2_KERNELS
+
+namespace Avx2 {
+
+constexpr size_t Lanes = 4;
+
+AVX2_TARGET inline __m256i Load(const Operand<int64_t>& operand, size_t i)
+{
+    if (operand.data)
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(operand.data + i));
+    return _mm256_set1_epi64x(operand.scalar);
+}
+
+AVX2_TARGET inline __m256d Load(const Operand<double>& operand, size_t i)
+{
+    if (operand.data)
+        return _mm256_loadu_pd(operand.data + i);
+    return _mm256_set1_pd(operand.scalar);
+}
+
+AVX2_TARGET inline void Store(int64_t* out, size_t i, __m256i value)
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), value);
+}
+
+AVX2_TARGET inline void Store(double* out, size_t i, __m256d value)
+{
+    _mm256_storeu_pd(out + i, value);
+}
+
+// AVX2 has no 64-bit multiplication, so it's put together from the 32-bit
+// halves: the high halves of the cross products only affect bits past 64
+AVX2_TARGET inline __m256i Mul(__m256i lhs, __m256i rhs)
+{
+    __m256i low = _mm256_mul_epu32(lhs, rhs);
+    __m256i cross = _mm256_add_epi64(
+        _mm256_mul_epu32(_mm256_srli_epi64(lhs, 32), rhs),
+        _mm256_mul_epu32(lhs, _mm256_srli_epi64(rhs, 32))
+    );
+    return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+}
+
+template <ElementOp Op>
+AVX2_TARGET inline __m256i Combine(__m256i lhs, __m256i rhs)
+{
+    if constexpr (Op == ElementOp::Add)
+        return _mm256_add_epi64(lhs, rhs);
+    else if constexpr (Op == ElementOp::Sub)
+        return _mm256_sub_epi64(lhs, rhs);
+    else
+        return Mul(lhs, rhs);
+}
+
+template <ElementOp Op>
+AVX2_TARGET inline __m256d Combine(__m256d lhs, __m256d rhs)
+{
+    if constexpr (Op == ElementOp::Add)
+        return _mm256_add_pd(lhs, rhs);
+    else if constexpr (Op == ElementOp::Sub)
+        return _mm256_sub_pd(lhs, rhs);
+    else
+        return _mm256_mul_pd(lhs, rhs);
+}
+
+// Returns how many elements were processed
+template <ElementOp Op, typename T>
+AVX2_TARGET size_t Apply(Operand<T> lhs, Operand<T> rhs, T* out, size_t n)
+{
+    size_t i = 0;
+    for (; i + Lanes <= n; i += Lanes)
+    {
+        Store(out, i, Combine<Op>(Load(lhs, i), Load(rhs, i)));
+    }
+    return i;
+}
+
+template <typename T>
+size_t Apply(ElementOp op, Operand<T> lhs, Operand<T> rhs, T* out, size_t n)
+{
+    switch (op)
+    {
+    case ElementOp::Add:
+        return Apply<ElementOp::Add>(lhs, rhs, out, n);
+    case ElementOp::Sub:
+        return Apply<ElementOp::Sub>(lhs, rhs, out, n);
+    case ElementOp::Mul:
+        return Apply<ElementOp::Mul>(lhs, rhs, out, n);
+    }
+    return 0;
+}
+
+// All ones in the lanes where the comparison holds
+template <CompareOp Op>
+AVX2_TARGET inline __m256i Mask(__m256i lhs, __m256i rhs)
+{
+    __m256i ones = _mm256_set1_epi64x(-1);
+    if constexpr (Op == CompareOp::Less)
+        return _mm256_cmpgt_epi64(rhs, lhs);
+    else if constexpr (Op == CompareOp::LessOrEqual)
+        return _mm256_xor_si256(_mm256_cmpgt_epi64(lhs, rhs), ones);
+    else if constexpr (Op == CompareOp::Greater)
+        return _mm256_cmpgt_epi64(lhs, rhs);
+    else if constexpr (Op == CompareOp::GreaterOrEqual)
+        return _mm256_xor_si256(_mm256_cmpgt_epi64(rhs, lhs), ones);
+    else if constexpr (Op == CompareOp::Equal)
+        return _mm256_cmpeq_epi64(lhs, rhs);
+    else
+        return _mm256_xor_si256(_mm256_cmpeq_epi64(lhs, rhs), ones);
+}
+
+template <CompareOp Op>
+AVX2_TARGET inline __m256i Mask(__m256d lhs, __m256d rhs)
+{
+    __m256d mask;
+    if constexpr (Op == CompareOp::Less)
+        mask = _mm256_cmp_pd(lhs, rhs, _CMP_LT_OQ);
+    else if constexpr (Op == CompareOp::LessOrEqual)
+        mask = _mm256_cmp_pd(lhs, rhs, _CMP_LE_OQ);
+    else if constexpr (Op == CompareOp::Greater)
+        mask = _mm256_cmp_pd(lhs, rhs, _CMP_GT_OQ);
+    else if constexpr (Op == CompareOp::GreaterOrEqual)
+        mask = _mm256_cmp_pd(lhs, rhs, _CMP_GE_OQ);
+    else if constexpr (Op == CompareOp::Equal)
+        mask = _mm256_cmp_pd(lhs, rhs, _CMP_EQ_OQ);
+    else
+        mask = _mm256_cmp_pd(lhs, rhs, _CMP_NEQ_UQ);
+    return _mm256_castpd_si256(mask);
+}
+
+template <CompareOp Op, typename T>
+AVX2_TARGET size_t Compare(Operand<T> lhs, Operand<T> rhs, int64_t* out, size_t n)
+{
+    __m256i one = _mm256_set1_epi64x(1);
+    size_t i = 0;
+    for (; i + Lanes <= n; i += Lanes)
+    {
+        Store(out, i, _mm256_and_si256(Mask<Op>(Load(lhs, i), Load(rhs, i)), one));
+    }
+    return i;
+}
+
+template <typename T>
+size_t Compare(CompareOp op, Operand<T> lhs, Operand<T> rhs, int64_t* out, size_t n)
+{
+    switch (op)
+    {
+    case CompareOp::Less:
+        return Compare<CompareOp::Less>(lhs, rhs, out, n);
+    case CompareOp::LessOrEqual:
+        return Compare<CompareOp::LessOrEqual>(lhs, rhs, out, n);
+    case CompareOp::Greater:
+        return Compare<CompareOp::Greater>(lhs, rhs, out, n);
+    case CompareOp::GreaterOrEqual:
+        return Compare<CompareOp::GreaterOrEqual>(lhs, rhs, out, n);
+    case CompareOp::Equal:
+        return Compare<CompareOp::Equal>(lhs, rhs, out, n);
+    case CompareOp::NotEqual:
+        return Compare<CompareOp::NotEqual>(lhs, rhs, out, n);
+    }
+    return 0;
+}
+
+AVX2_TARGET inline int64_t HorizontalSum(__m256i value)
+{
+    alignas(32) int64_t lanes[Lanes];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), value);
+    return static_cast<int64_t>(static_cast<uint64_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3]);
+}
+
+AVX2_TARGET inline double HorizontalSum(__m256d value)
+{
+    alignas(32) double lanes[Lanes];
+    _mm256_store_pd(lanes, value);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+// The reductions below process the first n rounded down to whole vectors
+// and store the count in done
+
+AVX2_TARGET int64_t Sum(const int64_t* data, size_t n, size_t& done)
+{
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + Lanes <= n; i += Lanes)
+    {
+        sum = _mm256_add_epi64(sum, Load(Operand<int64_t>{data + i}, 0));
+    }
+    done = i;
+    return HorizontalSum(sum);
+}
+
+AVX2_TARGET double Sum(const double* data, size_t n, size_t& done)
+{
+    // Two accumulators hide the latency of the additions
+    __m256d first = _mm256_setzero_pd();
+    __m256d second = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 2 * Lanes <= n; i += 2 * Lanes)
+    {
+        first = _mm256_add_pd(first, _mm256_loadu_pd(data + i));
+        second = _mm256_add_pd(second, _mm256_loadu_pd(data + i + Lanes));
+    }
+    for (; i + Lanes <= n; i += Lanes)
+    {
+        first = _mm256_add_pd(first, _mm256_loadu_pd(data + i));
+    }
+    done = i;
+    return HorizontalSum(_mm256_add_pd(first, second));
+}
+
+template <bool IsMin>
+AVX2_TARGET int64_t Extremum(const int64_t* data, size_t n, size_t& done)
+{
+    __m256i result = _mm256_set1_epi64x(data[0]);
+    size_t i = 0;
+    for (; i + Lanes <= n; i += Lanes)
+    {
+        __m256i value = Load(Operand<int64_t>{data + i}, 0);
+        __m256i replace = IsMin ? _mm256_cmpgt_epi64(result, value) : _mm256_cmpgt_epi64(value, result);
+        result = _mm256_blendv_epi8(result, value, replace);
+    }
+    done = i;
+
+    alignas(32) int64_t lanes[Lanes];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), result);
+    return IsMin ? *std::min_element(lanes, lanes + Lanes) : *std::max_element(lanes, lanes + Lanes);
+}
+
+template <bool IsMin>
+AVX2_TARGET double Extremum(const double* data, size_t n, size_t& done)
+{
+    __m256d result = _mm256_set1_pd(data[0]);
+    size_t i = 0;
+    for (; i + Lanes <= n; i += Lanes)
+    {
+        __m256d value = _mm256_loadu_pd(data + i);
+        result = IsMin ? _mm256_min_pd(result, value) : _mm256_max_pd(result, value);
+    }
+    done = i;
+
+    alignas(32) double lanes[Lanes];
+    _mm256_store_pd(lanes, result);
+    return IsMin ? *std::min_element(lanes, lanes + Lanes) : *std::max_element(lanes, lanes + Lanes);
+}
+
+AVX2_TARGET int64_t Dot(const int64_t* lhs, const int64_t* rhs, size_t n, size_t& done)
+{
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + Lanes <= n; i += Lanes)
+    {
+        sum = _mm256_add_epi64(sum, Mul(Load(Operand<int64_t>{lhs + i}, 0), Load(Operand<int64_t>{rhs + i}, 0)));
+    }
+    done = i;
+    return HorizontalSum(sum);
+}
+
+AVX2_TARGET double Dot(const double* lhs, const double* rhs, size_t n, size_t& done)
+{
+    __m256d sum = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + Lanes <= n; i += Lanes)
+    {
+        sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_loadu_pd(lhs + i), _mm256_loadu_pd(rhs + i)));
+    }
+    done = i;
+    return HorizontalSum(sum);
+}
+
+}
+
+#endif
+
+template <typename T>
+T SumImpl(const T* data, size_t n)
+{
+    T sum = 0;
+    size_t i = 0;
+#ifdef HAVE_AVX2_KERNELS
+    if (HasAvx2())
+        sum = Avx2::Sum(data, n, i);
+#endif
+    for (; i < n; i++)
+    {
+        sum = Combine(ElementOp::Add, sum, data[i]);
+    }
+    return sum;
+}
+
+template <bool IsMin, typename T>
+T ExtremumImpl(const T* data, size_t n)
+{
+    T result = data[0];
+    size_t i = 0;
+#ifdef HAVE_AVX2_KERNELS
+    if (HasAvx2())
+        result = Avx2::Extremum<IsMin>(data, n, i);
+#endif
+    for (; i < n; i++)
+    {
+        result = IsMin ? std::min(result, data[i]) : std::max(result, data[i]);
+    }
+    return result;
+}
+
+template <typename T>
+T DotImpl(const T* lhs, const T* rhs, size_t n)
+{
+    T sum = 0;
+    size_t i = 0;
+#ifdef HAVE_AVX2_KERNELS
+    if (HasAvx2())
+        sum = Avx2::Dot(lhs, rhs, n, i);
+#endif
+    for (; i < n; i++)
+    {
+        sum = Combine(ElementOp::Add, sum, Combine(ElementOp::Mul, lhs[i], rhs[i]));
+    }
+    return sum;
+}
+
+template <typename T>
+void ApplyImpl(ElementOp op, Operand<T> lhs, Operand<T> rhs, T* out, size_t n)
+{
+    size_t done = 0;
+#ifdef HAVE_AVX2_KERNELS
+    if (HasAvx2())
+        done = Avx2::Apply(op, lhs, rhs, out, n);
+#endif
+    ScalarApply(op, lhs, rhs, out, n, done);
+}
+
+template <typename T>
+void CompareImpl(CompareOp op, Operand<T> lhs, Operand<T> rhs, int64_t* out, size_t n)
+{
+    size_t done = 0;
+#ifdef HAVE_AVX2_KERNELS
+    if (HasAvx2())
+        done = Avx2::Compare(op, lhs, rhs, out, n);
+#endif
+    ScalarCompare(op, lhs, rhs, out, n, done);
+}
+
+}
+
+bool HasAvx2()
+{
+#ifdef HAVE_AVX2_KERNELS
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported && s_Avx2Enabled;
+#else
+    return false;
+#endif
+}
+
+void SetAvx2Enabled(bool enabled)
+{
+    s_Avx2Enabled = enabled;
+}
+
+void Apply(ElementOp op, Operand<int64_t> lhs, Operand<int64_t> rhs, int64_t* out, size_t n)
+{
+    ApplyImpl(op, lhs, rhs, out, n);
+}
+
+void Apply(ElementOp op, Operand<double> lhs, Operand<double> rhs, double* out, size_t n)
+{
+    ApplyImpl(op, lhs, rhs, out, n);
+}
+
+void Compare(CompareOp op, Operand<int64_t> lhs, Operand<int64_t> rhs, int64_t* out, size_t n)
+{
+    CompareImpl(op, lhs, rhs, out, n);
+}
+
+void Compare(CompareOp op, Operand<double> lhs, Operand<double> rhs, int64_t* out, size_t n)
+{
+    CompareImpl(op, lhs, rhs, out, n);
+}
+
+int64_t Sum(const int64_t* data, size_t n)
+{
+    return SumImpl(data, n);
+}
+
+double Sum(const double* data, size_t n)
+{
+    return SumImpl(data, n);
+}
+
+int64_t Min(const int64_t* data, size_t n)
+{
+    return ExtremumImpl<true>(data, n);
+}
+
+double Min(const double* data, size_t n)
+{
+    return ExtremumImpl<true>(data, n);
+}
+
+int64_t Max(const int64_t* data, size_t n)
+{
+    return ExtremumImpl<false>(data, n);
+}
+
+double Max(const double* data, size_t n)
+{
+    return ExtremumImpl<false>(data, n);
+}
+
+int64_t Dot(const int64_t* lhs, const int64_t* rhs, size_t n)
+{
+    return DotImpl(lhs, rhs, n);
+}
+
+double Dot(const double* lhs, const double* rhs, size_t n)
+{
+    return DotImpl(lhs, rhs, n);
+}
+
+}
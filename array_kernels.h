@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "comparators.h"
+
+// Element-wise kernels of numeric arrays. Each of them uses AVX2 when the
+// CPU supports it and plain loops otherwise. Integer arithmetic wraps
+// around on overflow, and float reductions may sum in a different order
+// than a sequential loop would.
+namespace Runtime::Kernels {
+
+enum class ElementOp
+{
+    Add,
+    Sub,
+    Mul,
+};
+
+// Either an array of n elements or a scalar broadcast to all of them
+template <typename T>
+struct Operand
+{
+    const T* data = nullptr;
+    T scalar = 0;
+};
+
+bool HasAvx2();
+// Lets benchmarks compare against the scalar kernels
+void SetAvx2Enabled(bool enabled);
+
+void Apply(ElementOp op, Operand<int64_t> lhs, Operand<int64_t> rhs, int64_t* out, size_t n);
+void Apply(ElementOp op, Operand<double> lhs, Operand<double> rhs, double* out, size_t n);
+
+// Stores 1 where the comparison holds and 0 elsewhere
+void Compare(CompareOp op, Operand<int64_t> lhs, Operand<int64_t> rhs, int64_t* out, size_t n);
+void Compare(CompareOp op, Operand<double> lhs, Operand<double> rhs, int64_t* out, size_t n);
+
+int64_t Sum(const int64_t* data, size_t n);
+double Sum(const double* data, size_t n);
+
+// The arrays must not be empty
+int64_t Min(const int64_t* data, size_t n);
+double Min(const double* data, size_t n);
+int64_t Max(const int64_t* data, size_t n);
+double Max(const double* data, size_t n);
+
+int64_t Dot(const int64_t* lhs, const int64_t* rhs, size_t n);
+double Dot(const double* lhs, const double* rhs, size_t n);
+
+}
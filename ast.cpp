@@ -1,163 +1,682 @@
 #include "ast.h"
+#include "string_kernels.h"
+#include "generator.h"
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <concepts>
+#include <span>
+#include <utility>
 #include <iostream>
 #include <sstream>
+#include <unistd.h>
 
 namespace AST {
 
-ObjectHolder Add::Evaluate(Runtime::Closure& closure)
+namespace {
+
+// Bools are immutable, so all the results share the same two objects
+ObjectHolder MakeBool(bool value)
+{
+    static const ObjectHolder True = ObjectHolder::Own(Runtime::Bool(true));
+    static const ObjectHolder False = ObjectHolder::Own(Runtime::Bool(false));
+    return value ? True : False;
+}
+
+int ToIndex(const ObjectHolder& index)
 {
-    ObjectHolder left = m_Left->Evaluate(closure);
-    ObjectHolder right = m_Right->Evaluate(closure);
+    if (const Runtime::Number* number = index.TryAs<Runtime::Number>())
+    {
+        return number->GetValue();
+    }
+    throw std::runtime_error("List indices must be integers");
+}
+
 
-    const Runtime::Number* leftNumber = left.TryAs<Runtime::Number>();
-    const Runtime::Number* rightNumber = right.TryAs<Runtime::Number>();
+int ToRangeBound(const Value& value)
+{
+    if (!value.IsInt())
+        throw std::runtime_error("range() arguments must be ints");
+    return value.GetInt();
+}
 
-    if (leftNumber && rightNumber)
+// Handles the completion of a loop body. Break and Continue end with the
+// loop, while Return goes on to the enclosing method call.
+bool LeavesLoop(Runtime::Context& context)
+{
+    switch (context.GetCompletion())
     {
-        return ObjectHolder::Own<Runtime::Number>(
-            Runtime::Number(leftNumber->GetValue() + rightNumber->GetValue())
-        );
+    case Runtime::Completion::Normal:
+        return false;
+    case Runtime::Completion::Continue:
+        context.ResumeNormal();
+        return false;
+    case Runtime::Completion::Break:
+        context.ResumeNormal();
+        return true;
+    default:
+        return true;
     }
+}
 
-    throw std::runtime_error("Addition isn't supported for these operands");
+// Checks a call for a raise of the callee, which is thrown unless the call
+// is right under a statement
+ObjectHolder CheckRaise(ObjectHolder result, Runtime::Context& context, bool leaveRaise)
+{
+    if (!leaveRaise && context.GetCompletion() == Runtime::Completion::Raise)
+        throw Runtime::Raised(context.TakeException());
+    return result;
 }
 
-ObjectHolder Sub::Evaluate(Runtime::Closure& closure)
+// Arguments of a call, evaluated into the caller's frame when there are few
+// of them, and handed to the callee as a span
+class ActualParams
 {
-    ObjectHolder left = m_Left->Evaluate(closure);
-    ObjectHolder right = m_Right->Evaluate(closure);
+public:
+    ActualParams(const std::vector<std::unique_ptr<Node>>& args, Runtime::Closure& closure, Runtime::Context& context)
+        : m_Size(args.size())
+    {
+        if (m_Size > InlineSize)
+            m_Heap.resize(m_Size);
+
+        ObjectHolder* params = GetData();
+        for (size_t i = 0; i < m_Size; i++)
+        {
+            params[i] = args[i]->Evaluate(closure, context);
+        }
+    }
 
-    const Runtime::Number* leftNumber = left.TryAs<Runtime::Number>();
-    const Runtime::Number* rightNumber = right.TryAs<Runtime::Number>();
+    std::span<const ObjectHolder> Get()
+    {
+        return {GetData(), m_Size};
+    }
+private:
+    static constexpr size_t InlineSize = 4;
 
-    if (leftNumber && rightNumber)
+    ObjectHolder* GetData()
     {
-        return ObjectHolder::Own<Runtime::Number>(
-            Runtime::Number(leftNumber->GetValue() - rightNumber->GetValue())
-        );
+        return m_Size > InlineSize ? m_Heap.data() : m_Inline.data();
     }
 
-    throw std::runtime_error("Substraction isn't supported for these operands");
+    std::array<ObjectHolder, InlineSize> m_Inline;
+    std::vector<ObjectHolder> m_Heap;
+    size_t m_Size;
+};
+
+bool IsInstanceOf(const ObjectHolder& object, const Runtime::Class& cls)
+{
+    const Runtime::ClassInstance* instance = object.TryAs<Runtime::ClassInstance>();
+    for (const Runtime::Class* c = instance ? &instance->GetClass() : nullptr; c; c = c->GetParent())
+    {
+        if (c == &cls)
+            return true;
+    }
+    return false;
 }
 
-ObjectHolder Mul::Evaluate(Runtime::Closure& closure)
+// Steps through the items of a container for a loop. The body may grow
+// lists and dicts, so their sizes are read anew on every step, and files
+// and generators produce their items as they are asked for.
+class Iteration
+{
+public:
+    explicit Iteration(ObjectHolder container)
+        : m_Container(std::move(container))
+    {
+        switch (Runtime::GetTypeTag(m_Container))
+        {
+        case Runtime::TypeTag::List:
+        case Runtime::TypeTag::Tuple:
+        case Runtime::TypeTag::Dict:
+        case Runtime::TypeTag::String:
+            return;
+        default:
+            if (m_Container.TryAs<Runtime::File>() || m_Container.TryAs<Runtime::Generator>())
+                return;
+            throw std::runtime_error("Object is not iterable");
+        }
+    }
+
+    std::optional<ObjectHolder> Next()
+    {
+        size_t i = m_Index++;
+        switch (Runtime::GetTypeTag(m_Container))
+        {
+        case Runtime::TypeTag::List:
+        {
+            const auto& list = static_cast<const Runtime::List&>(*m_Container);
+            return i < list.Size() ? std::optional(list.Get(static_cast<int>(i))) : std::nullopt;
+        }
+        case Runtime::TypeTag::Tuple:
+        {
+            const auto& tuple = static_cast<const Runtime::Tuple&>(*m_Container);
+            return i < tuple.Size() ? std::optional(tuple.GetItems()[i]) : std::nullopt;
+        }
+        case Runtime::TypeTag::Dict:
+        {
+            const auto& dict = static_cast<const Runtime::Dict&>(*m_Container);
+            return i < dict.Size() ? std::optional(dict.GetKey(i)) : std::nullopt;
+        }
+        case Runtime::TypeTag::String:
+        {
+            const auto& str = static_cast<const Runtime::String&>(*m_Container);
+            return i < str.Size() ? std::optional(ObjectHolder::Own(str.Slice(i, i + 1))) : std::nullopt;
+        }
+        default:
+            break;
+        }
+
+        if (Runtime::Generator* generator = m_Container.TryAs<Runtime::Generator>())
+            return generator->Next();
+
+        ObjectHolder line = m_Container.TryAs<Runtime::File>()->ReadLine();
+        if (static_cast<const Runtime::String&>(*line).Size() == 0)
+            return std::nullopt;
+        return line;
+    }
+private:
+    ObjectHolder m_Container;
+    size_t m_Index = 0;
+};
+
+template <typename T>
+concept Integer = std::same_as<T, Runtime::Number> || std::same_as<T, Runtime::BigInt>;
+
+template <typename T>
+concept ArrayScalar = std::same_as<T, Runtime::Number> || std::same_as<T, Runtime::Float>;
+
+// An array with an array or a scalar broadcast over it
+template <typename L, typename R>
+concept ArrayOperands = (std::same_as<L, Runtime::Array> && (std::same_as<R, Runtime::Array> || ArrayScalar<R>))
+    || (ArrayScalar<L> && std::same_as<R, Runtime::Array>);
+
+template <typename T>
+concept Real = Integer<T> || std::same_as<T, Runtime::Float>;
+
+// A float with a float or an integer, computed in double precision
+template <typename L, typename R>
+concept FloatOperands = Real<L> && Real<R> && (std::same_as<L, Runtime::Float> || std::same_as<R, Runtime::Float>);
+
+double ToDouble(const Runtime::Number& value)
+{
+    return value.GetValue();
+}
+
+double ToDouble(const Runtime::BigInt& value)
+{
+    return value.GetValue().ToDouble();
+}
+
+double ToDouble(const Runtime::Float& value)
+{
+    return value.GetValue();
+}
+
+BigInteger ToBigInteger(const Runtime::Number& value)
+{
+    return value.GetValue();
+}
+
+const BigInteger& ToBigInteger(const Runtime::BigInt& value)
+{
+    return value.GetValue();
+}
+
+// Implementations of an arithmetic operation, one Apply overload per pair of
+// operand types. Numbers are added, subtracted and multiplied as ints and
+// only go through BigInteger when the result overflows. ApplyInts and
+// ApplyFloats serve the unboxed operands of Arithmetic::EvaluateValue.
+template <ArithmeticOp Op>
+struct Operation;
+
+template <>
+struct Operation<ArithmeticOp::Add>
+{
+    static constexpr const char* Name = "Addition";
+
+    static std::optional<int> ApplyInts(int lhs, int rhs)
+    {
+        if (int result; !__builtin_add_overflow(lhs, rhs, &result))
+            return result;
+        return std::nullopt;
+    }
+
+    static double ApplyFloats(double lhs, double rhs)
+    {
+        return lhs + rhs;
+    }
+
+    static ObjectHolder Apply(const Runtime::Number& lhs, const Runtime::Number& rhs)
+    {
+        if (std::optional<int> result = ApplyInts(lhs.GetValue(), rhs.GetValue()))
+            return ObjectHolder::Own(Runtime::Number(*result));
+
+        return Runtime::MakeInteger(ToBigInteger(lhs) + ToBigInteger(rhs));
+    }
+
+    template <Integer L, Integer R>
+    static ObjectHolder Apply(const L& lhs, const R& rhs)
+    {
+        return Runtime::MakeInteger(ToBigInteger(lhs) + ToBigInteger(rhs));
+    }
+
+    template <typename L, typename R> requires FloatOperands<L, R>
+    static ObjectHolder Apply(const L& lhs, const R& rhs)
+    {
+        return ObjectHolder::Own(Runtime::Float(ApplyFloats(ToDouble(lhs), ToDouble(rhs))));
+    }
+
+    template <typename L, typename R> requires ArrayOperands<L, R>
+    static ObjectHolder Apply(const L& lhs, const R& rhs)
+    {
+        return Runtime::ApplyElements(Runtime::Kernels::ElementOp::Add, lhs, rhs);
+    }
+
+    static ObjectHolder Apply(const Runtime::String& lhs, const Runtime::String& rhs)
+    {
+        return ObjectHolder::Own(Runtime::String::Concat(lhs, rhs));
+    }
+};
+
+template <>
+struct Operation<ArithmeticOp::Sub>
+{
+    static constexpr const char* Name = "Substraction";
+
+    static std::optional<int> ApplyInts(int lhs, int rhs)
+    {
+        if (int result; !__builtin_sub_overflow(lhs, rhs, &result))
+            return result;
+        return std::nullopt;
+    }
+
+    static double ApplyFloats(double lhs, double rhs)
+    {
+        return lhs - rhs;
+    }
+
+    static ObjectHolder Apply(const Runtime::Number& lhs, const Runtime::Number& rhs)
+    {
+        if (std::optional<int> result = ApplyInts(lhs.GetValue(), rhs.GetValue()))
+            return ObjectHolder::Own(Runtime::Number(*result));
+
+        return Runtime::MakeInteger(ToBigInteger(lhs) - ToBigInteger(rhs));
+    }
+
+    template <Integer L, Integer R>
+    static ObjectHolder Apply(const L& lhs, const R& rhs)
+    {
+        return Runtime::MakeInteger(ToBigInteger(lhs) - ToBigInteger(rhs));
+    }
+
+    template <typename L, typename R> requires FloatOperands<L, R>
+    static ObjectHolder Apply(const L& lhs, const R& rhs)
+    {
+        return ObjectHolder::Own(Runtime::Float(ApplyFloats(ToDouble(lhs), ToDouble(rhs))));
+    }
+
+    template <typename L, typename R> requires ArrayOperands<L, R>
+    static ObjectHolder Apply(const L& lhs, const R& rhs)
+    {
+        return Runtime::ApplyElements(Runtime::Kernels::ElementOp::Sub, lhs, rhs);
+    }
+};
+
+template <>
+struct Operation<ArithmeticOp::Mul>
+{
+    static constexpr const char* Name = "Multiplication";
+
+    static std::optional<int> ApplyInts(int lhs, int rhs)
+    {
+        if (int result; !__builtin_mul_overflow(lhs, rhs, &result))
+            return result;
+        return std::nullopt;
+    }
+
+    static double ApplyFloats(double lhs, double rhs)
+    {
+        return lhs * rhs;
+    }
+
+    static ObjectHolder Apply(const Runtime::Number& lhs, const Runtime::Number& rhs)
+    {
+        if (std::optional<int> result = ApplyInts(lhs.GetValue(), rhs.GetValue()))
+            return ObjectHolder::Own(Runtime::Number(*result));
+
+        return Runtime::MakeInteger(ToBigInteger(lhs) * ToBigInteger(rhs));
+    }
+
+    template <Integer L, Integer R>
+    static ObjectHolder Apply(const L& lhs, const R& rhs)
+    {
+        return Runtime::MakeInteger(ToBigInteger(lhs) * ToBigInteger(rhs));
+    }
+
+    template <typename L, typename R> requires FloatOperands<L, R>
+    static ObjectHolder Apply(const L& lhs, const R& rhs)
+    {
+        return ObjectHolder::Own(Runtime::Float(ApplyFloats(ToDouble(lhs), ToDouble(rhs))));
+    }
+
+    template <typename L, typename R> requires ArrayOperands<L, R>
+    static ObjectHolder Apply(const L& lhs, const R& rhs)
+    {
+        return Runtime::ApplyElements(Runtime::Kernels::ElementOp::Mul, lhs, rhs);
+    }
+
+    static ObjectHolder Apply(const Runtime::String& lhs, const Runtime::Number& rhs)
+    {
+        return ObjectHolder::Own(Runtime::String::Repeat(lhs, rhs.GetValue()));
+    }
+
+    static ObjectHolder Apply(const Runtime::Number& lhs, const Runtime::String& rhs)
+    {
+        return ObjectHolder::Own(Runtime::String::Repeat(rhs, lhs.GetValue()));
+    }
+};
+
+template <>
+struct Operation<ArithmeticOp::Div>
 {
-    ObjectHolder left = m_Left->Evaluate(closure);
-    ObjectHolder right = m_Right->Evaluate(closure);
+    static constexpr const char* Name = "Division";
+
+    // INT_MIN / -1 is the only quotient that doesn't fit into int
+    static std::optional<int> ApplyInts(int lhs, int rhs)
+    {
+        if (rhs == 0 || (lhs == INT_MIN && rhs == -1))
+            return std::nullopt;
+        return lhs / rhs;
+    }
 
-    const Runtime::Number* leftNumber = left.TryAs<Runtime::Number>();
-    const Runtime::Number* rightNumber = right.TryAs<Runtime::Number>();
+    static double ApplyFloats(double lhs, double rhs)
+    {
+        if (rhs == 0)
+            throw std::runtime_error("Division by zero");
+        return lhs / rhs;
+    }
+
+    static ObjectHolder Apply(const Runtime::Number& lhs, const Runtime::Number& rhs)
+    {
+        if (rhs.GetValue() == 0)
+            throw std::runtime_error("Division by zero");
+
+        if (std::optional<int> result = ApplyInts(lhs.GetValue(), rhs.GetValue()))
+            return ObjectHolder::Own(Runtime::Number(*result));
+
+        return Runtime::MakeInteger(-ToBigInteger(lhs));
+    }
+
+    template <Integer L, Integer R>
+    static ObjectHolder Apply(const L& lhs, const R& rhs)
+    {
+        return Runtime::MakeInteger(ToBigInteger(lhs) / ToBigInteger(rhs));
+    }
 
-    if (leftNumber && rightNumber)
+    template <typename L, typename R> requires FloatOperands<L, R>
+    static ObjectHolder Apply(const L& lhs, const R& rhs)
     {
-        return ObjectHolder::Own<Runtime::Number>(
-            Runtime::Number(leftNumber->GetValue() * rightNumber->GetValue())
-        );
+        return ObjectHolder::Own(Runtime::Float(ApplyFloats(ToDouble(lhs), ToDouble(rhs))));
     }
+};
+
+using BinaryHandler = ObjectHolder (*)(const ObjectHolder& lhs, const ObjectHolder& rhs);
+
+constexpr size_t TagCount = static_cast<size_t>(Runtime::TypeTag::Count);
 
-    throw std::runtime_error("Multiplication isn't supported for these operands");
+template <ArithmeticOp Op, Runtime::TypeTag Left, Runtime::TypeTag Right>
+ObjectHolder Dispatch(const ObjectHolder& lhs, const ObjectHolder& rhs)
+{
+    return Operation<Op>::Apply(
+        static_cast<const typename Runtime::TaggedType<Left>::Type&>(*lhs),
+        static_cast<const typename Runtime::TaggedType<Right>::Type&>(*rhs)
+    );
 }
 
-ObjectHolder Div::Evaluate(Runtime::Closure& closure)
+template <ArithmeticOp Op, size_t Index>
+constexpr BinaryHandler MakeHandler()
 {
-    ObjectHolder left = m_Left->Evaluate(closure);
-    ObjectHolder right = m_Right->Evaluate(closure);
+    constexpr Runtime::TypeTag Left = static_cast<Runtime::TypeTag>(Index / TagCount);
+    constexpr Runtime::TypeTag Right = static_cast<Runtime::TypeTag>(Index % TagCount);
+    using L = typename Runtime::TaggedType<Left>::Type;
+    using R = typename Runtime::TaggedType<Right>::Type;
 
-    const Runtime::Number* leftNumber = left.TryAs<Runtime::Number>();
-    const Runtime::Number* rightNumber = right.TryAs<Runtime::Number>();
+    if constexpr (Left != Runtime::TypeTag::None && Right != Runtime::TypeTag::None
+                  && requires (const L& lhs, const R& rhs) { Operation<Op>::Apply(lhs, rhs); })
+    {
+        return &Dispatch<Op, Left, Right>;
+    }
+    else
+    {
+        return nullptr;
+    }
+}
+
+template <ArithmeticOp Op, size_t ...Indices>
+constexpr std::array<BinaryHandler, TagCount * TagCount> MakeDispatchTable(std::index_sequence<Indices...>)
+{
+    return {MakeHandler<Op, Indices>()...};
+}
+
+template <ArithmeticOp Op>
+constexpr std::array<BinaryHandler, TagCount * TagCount> DispatchTable =
+    MakeDispatchTable<Op>(std::make_index_sequence<TagCount * TagCount>());
 
-    if (rightNumber->GetValue() == 0)
-        throw std::runtime_error("Division by zero");
+template <ArithmeticOp Op>
+ObjectHolder ApplyObjects(const ObjectHolder& left, const ObjectHolder& right)
+{
+    size_t index = static_cast<size_t>(Runtime::GetTypeTag(left)) * TagCount
+        + static_cast<size_t>(Runtime::GetTypeTag(right));
 
-    if (leftNumber && rightNumber)
+    if (BinaryHandler handler = DispatchTable<Op>[index])
     {
-        return ObjectHolder::Own<Runtime::Number>(
-            Runtime::Number(leftNumber->GetValue() / rightNumber->GetValue())
-        );
+        return handler(left, right);
     }
 
-    throw std::runtime_error("Division isn't supported for these operands");
+    throw std::runtime_error(std::string(Operation<Op>::Name) + " isn't supported for these operands");
+}
+
+}
+
+template <ArithmeticOp Op>
+ObjectHolder Arithmetic<Op>::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    return EvaluateValue(closure, context).Box();
 }
 
-ObjectHolder Or::Evaluate(Runtime::Closure& closure)
+template <ArithmeticOp Op>
+Value Arithmetic<Op>::EvaluateValue(Runtime::Closure& closure, Runtime::Context& context)
 {
-    if (Runtime::IsTrue(m_Left->Evaluate(closure)) || Runtime::IsTrue(m_Right->Evaluate(closure)))
+    Value left = m_Left->EvaluateValue(closure, context);
+    Value right = m_Right->EvaluateValue(closure, context);
+
+    if (left.IsInt() && right.IsInt())
     {
-        return ObjectHolder::Own(Runtime::Bool(true));
+        if (std::optional<int> result = Operation<Op>::ApplyInts(left.GetInt(), right.GetInt()))
+            return Value::FromInt(*result);
+    }
+    else if (left.IsNumeric() && right.IsNumeric())
+    {
+        return Value::FromFloat(Operation<Op>::ApplyFloats(left.ToDouble(), right.ToDouble()));
+    }
+
+    // Overflows, division by zero and everything that isn't an int or a float
+    return Value::FromObject(ApplyObjects<Op>(std::move(left).Box(), std::move(right).Box()));
+}
+
+template class Arithmetic<ArithmeticOp::Add>;
+template class Arithmetic<ArithmeticOp::Sub>;
+template class Arithmetic<ArithmeticOp::Mul>;
+template class Arithmetic<ArithmeticOp::Div>;
+
+ObjectHolder Or::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    if (Runtime::IsTrue(m_Left->Evaluate(closure, context)) || Runtime::IsTrue(m_Right->Evaluate(closure, context)))
+    {
+        return MakeBool(true);
     }
     else
     {
-        return ObjectHolder::Own(Runtime::Bool(false));
+        return MakeBool(false);
     }
 }
 
-ObjectHolder And::Evaluate(Runtime::Closure& closure)
+ObjectHolder And::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
 {
-    if (Runtime::IsTrue(m_Left->Evaluate(closure)) && Runtime::IsTrue(m_Right->Evaluate(closure)))
+    if (Runtime::IsTrue(m_Left->Evaluate(closure, context)) && Runtime::IsTrue(m_Right->Evaluate(closure, context)))
     {
-        return ObjectHolder::Own(Runtime::Bool(true));
+        return MakeBool(true);
     }
     else
     {
-        return ObjectHolder::Own(Runtime::Bool(false));
+        return MakeBool(false);
     }
 }
 
-ObjectHolder Negate::Evaluate(Runtime::Closure& closure)
+ObjectHolder Negate::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
 {
-    ObjectHolder node = m_Arg->Evaluate(closure);
-    const Runtime::Number* number = node.TryAs<Runtime::Number>();
+    return EvaluateValue(closure, context).Box();
+}
+
+Value Negate::EvaluateValue(Runtime::Closure& closure, Runtime::Context& context)
+{
+    Value value = m_Arg->EvaluateValue(closure, context);
 
-    if (number)
+    if (value.IsInt() && value.GetInt() != INT_MIN)
     {
-        return ObjectHolder::Own<Runtime::Number>(
-            Runtime::Number(-number->GetValue())
-        );
+        return Value::FromInt(-value.GetInt());
+    }
+
+    if (value.IsFloat())
+    {
+        return Value::FromFloat(-value.GetFloat());
+    }
+
+    if (std::optional<BigInteger> integer = Runtime::ToBigInteger(std::move(value).Box()))
+    {
+        return Value::FromObject(Runtime::MakeInteger(-*integer));
     }
 
     throw std::runtime_error("Operation isn't supported");
 }
 
-ObjectHolder Positive::Evaluate(Runtime::Closure& closure)
+ObjectHolder Positive::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    return EvaluateValue(closure, context).Box();
+}
+
+Value Positive::EvaluateValue(Runtime::Closure& closure, Runtime::Context& context)
 {
-    ObjectHolder node = m_Arg->Evaluate(closure);
-    const Runtime::Number* number = node.TryAs<Runtime::Number>();
+    Value value = m_Arg->EvaluateValue(closure, context);
+
+    if (value.IsNumeric())
+    {
+        return value;
+    }
 
-    if (number)
+    ObjectHolder node = std::move(value).Box();
+    if (node.TryAs<Runtime::BigInt>())
     {
-        return ObjectHolder::Own<Runtime::Number>(
-            Runtime::Number(number->GetValue())
-        );
+        return Value::FromObject(std::move(node));
     }
 
     throw std::runtime_error("Operation isn't supported");
 }
 
-ObjectHolder Not::Evaluate(Runtime::Closure& closure)
+ObjectHolder Not::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
 {
-    return ObjectHolder::Own(Runtime::Bool(!Runtime::IsTrue(m_Arg->Evaluate(closure))));
+    return MakeBool(!Runtime::IsTrue(m_Arg->Evaluate(closure, context)));
 }
 
-ObjectHolder Compound::Evaluate(Runtime::Closure& closure)
+Execution Node::Execute(Runtime::Closure& closure, Runtime::Context& context)
+{
+    Evaluate(closure, context);
+    co_return;
+}
+
+ObjectHolder Compound::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
 {
     for (auto& node : m_Nodes)
     {
-        node->Evaluate(closure);
+        node->Evaluate(closure, context);
+
+        if (context.IsInterrupted())
+            break;
     }
     return ObjectHolder::None();
 }
 
-ObjectHolder Assign::Evaluate(Runtime::Closure& closure)
+Execution Compound::Execute(Runtime::Closure& closure, Runtime::Context& context)
 {
-    return closure[m_VarName] = m_Expr->Evaluate(closure);
+    for (auto& node : m_Nodes)
+    {
+        co_await Step(*node, closure, context);
+
+        if (context.IsInterrupted())
+            break;
+    }
+}
+
+ObjectHolder Assign::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    ObjectHolder value = m_Expr->Evaluate(closure, context);
+    if (context.IsInterrupted())
+        return value;
+    return closure[m_VarName] = std::move(value);
+}
+
+ObjectHolder UnpackAssign::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    ObjectHolder value = m_Expr->Evaluate(closure, context);
+    size_t count = m_VarNames.size();
+
+    if (const Runtime::Tuple* tuple = value.TryAs<Runtime::Tuple>(); tuple && tuple->Size() == count)
+    {
+        std::span<const ObjectHolder> items = tuple->GetItems();
+        for (size_t i = 0; i < count; i++)
+        {
+            closure[m_VarNames[i]] = items[i];
+        }
+    }
+    else if (const Runtime::List* list = value.TryAs<Runtime::List>(); list && list->Size() == count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            closure[m_VarNames[i]] = list->Get(static_cast<int>(i));
+        }
+    }
+    else if (Runtime::Generator* generator = value.TryAs<Runtime::Generator>())
+    {
+        // Stops at one item too many, generators may be endless
+        std::vector<ObjectHolder> items;
+        while (items.size() <= count)
+        {
+            std::optional<ObjectHolder> item = generator->Next();
+            if (!item)
+                break;
+            items.push_back(std::move(*item));
+        }
+        if (items.size() != count)
+            throw std::runtime_error("Cannot unpack the value into " + std::to_string(count) + " variables");
+
+        for (size_t i = 0; i < count; i++)
+        {
+            closure[m_VarNames[i]] = std::move(items[i]);
+        }
+    }
+    else
+    {
+        throw std::runtime_error("Cannot unpack the value into " + std::to_string(count) + " variables");
+    }
+    return value;
 }
 
-ObjectHolder FieldAssign::Evaluate(Runtime::Closure& closure)
+ObjectHolder FieldAssign::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
 {
-    ObjectHolder instance = m_Object->Evaluate(closure);
+    ObjectHolder instance = m_Object->Evaluate(closure, context);
     if (auto p = instance.TryAs<Runtime::ClassInstance>())
     {
-        return p->GetFields()[m_FieldName] = m_Expr->Evaluate(closure);
+        return p->GetFields()[m_FieldName] = Runtime::DetachSlice(m_Expr->Evaluate(closure, context));
     }
     else
     {
@@ -165,7 +684,7 @@ ObjectHolder FieldAssign::Evaluate(Runtime::Closure& closure)
     }
 }
 
-ObjectHolder VariableValue::Evaluate(Runtime::Closure& closure)
+ObjectHolder VariableValue::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
 {
     Runtime::Closure* currentClosure = &closure;
 
@@ -195,119 +714,734 @@ ObjectHolder VariableValue::Evaluate(Runtime::Closure& closure)
     }
 }
 
-std::ostream* Print::s_Output = &std::cout;
+ObjectHolder FieldValue::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    ObjectHolder object = m_Object->Evaluate(closure, context);
+    const Runtime::ClassInstance* instance = object.TryAs<Runtime::ClassInstance>();
+    if (!instance)
+        throw std::runtime_error("Cannot read the field " + m_FieldName + " of not an object");
+
+    if (auto it = instance->GetFields().find(m_FieldName); it != instance->GetFields().end())
+        return it->second;
+    throw std::runtime_error("Field " + m_FieldName + " not found in object");
+}
+
+std::unique_ptr<Node> FieldValue::MakeAssign(std::unique_ptr<Node> value)
+{
+    return std::make_unique<FieldAssign>(std::move(m_Object), std::move(m_FieldName), std::move(value));
+}
+
+std::unique_ptr<Runtime::OutputSink> Print::s_Output = std::make_unique<Runtime::FdSink>(STDOUT_FILENO);
 
 std::unique_ptr<Print> Print::Variable(std::string name)
 {
     return std::make_unique<Print>(std::make_unique<VariableValue>(std::move(name)));
 }
 
-ObjectHolder Print::Evaluate(Runtime::Closure& closure)
+ObjectHolder Print::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
 {
+    Runtime::OutputSink& output = *s_Output;
     bool first = true;
     for (const auto& arg : m_Args)
     {
         if (!first)
         {
-            (*s_Output) << ' ';
+            output.Write(" ");
         }
         first = false;
 
-        if (ObjectHolder result = arg->Evaluate(closure))
-        {
-            result->Print(*s_Output);
-        }
-        else
+        // Scalars are written to the buffer directly, other objects print
+        // through its stream
+        ObjectHolder result = arg->Evaluate(closure, context);
+        switch (Runtime::GetTypeTag(result))
         {
-            (*s_Output) << "None";
+        case Runtime::TypeTag::None:
+            output.Write("None");
+            break;
+        case Runtime::TypeTag::String:
+            output.Write(static_cast<const Runtime::String&>(*result).GetValue());
+            break;
+        case Runtime::TypeTag::Number:
+            output.WriteInt(static_cast<const Runtime::Number&>(*result).GetValue());
+            break;
+        case Runtime::TypeTag::Bool:
+            output.Write(static_cast<const Runtime::Bool&>(*result).GetValue() ? "True" : "False");
+            break;
+        default:
+            result->Print(output.GetStream(), context);
+            break;
         }
     }
-    (*s_Output) << '\n';
+    output.EndLine();
     return ObjectHolder::None();
 }
 
+Runtime::OutputSink& Print::GetOutput()
+{
+    return *s_Output;
+}
+
+void Print::SetOutput(std::unique_ptr<Runtime::OutputSink> output)
+{
+    s_Output->Flush();
+    s_Output = std::move(output);
+}
+
 void Print::SetOutputStream(std::ostream& os)
 {
-    s_Output = &os;
+    SetOutput(std::make_unique<Runtime::StreamSink>(os));
 }
 
-ObjectHolder MethodCall::Evaluate(Runtime::Closure& closure)
+ObjectHolder MethodCall::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
 {
-    std::vector<ObjectHolder> actualParams;
-    for (const auto& arg : m_Args)
+    ActualParams args(m_Args, closure, context);
+    std::span<const ObjectHolder> actualParams = args.Get();
+
+    ObjectHolder calee = m_Object->Evaluate(closure, context);
+    switch (Runtime::GetTypeTag(calee))
+    {
+    case Runtime::TypeTag::Instance:
+    {
+        Runtime::ClassInstance& instance = static_cast<Runtime::ClassInstance&>(*calee);
+        if (const Runtime::Method* method = LookupMethod(instance.GetClass()))
+        {
+            return CheckRaise(instance.Call(*method, actualParams, context), context, m_LeaveRaise);
+        }
+        return instance.Call(m_Method, actualParams, context);
+    }
+    case Runtime::TypeTag::List:
+        return static_cast<Runtime::List&>(*calee).Call(m_Method, actualParams);
+    case Runtime::TypeTag::Dict:
+        return static_cast<Runtime::Dict&>(*calee).Call(m_Method, actualParams, context);
+    case Runtime::TypeTag::Array:
+        return static_cast<Runtime::Array&>(*calee).Call(m_Method, actualParams);
+    case Runtime::TypeTag::String:
+        return static_cast<const Runtime::String&>(*calee).Call(m_Method, actualParams);
+    default:
+        if (Runtime::File* file = calee.TryAs<Runtime::File>())
+            return file->Call(m_Method, actualParams);
+        throw std::runtime_error("Trying to call method " + m_Method + " on an object that is not a class instance");
+    }
+}
+
+const Runtime::Method* MethodCall::LookupMethod(const Runtime::Class& cls)
+{
+    for (size_t i = 0; i < m_CacheSize; i++)
+    {
+        if (m_Cache[i].cls == &cls)
+        {
+            return m_Cache[i].method;
+        }
+    }
+
+    const Runtime::Method* method = cls.GetMethod(m_Method);
+    if (method && m_CacheSize < CacheSize)
+    {
+        m_Cache[m_CacheSize++] = {&cls, method};
+    }
+    return method;
+}
+
+ObjectHolder NewInstance::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    Runtime::Collector::Get().MaybeCollect();
+    ObjectHolder instance = ObjectHolder::Make<Runtime::ClassInstance>(m_Class);
+
+    if (const Runtime::Method* m = m_Class.GetMethod("__init__"); m)
+    {
+        ActualParams args(m_Args, closure, context);
+        static_cast<Runtime::ClassInstance&>(*instance).Call(*m, args.Get(), context);
+    }
+
+    return CheckRaise(std::move(instance), context, m_LeaveRaise);
+}
+
+ObjectHolder FunctionCall::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    ActualParams args(m_Args, closure, context);
+    return CheckRaise(m_Function.Call(args.Get(), context), context, m_LeaveRaise);
+}
+
+ObjectHolder Stringify::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    ObjectHolder value = m_Arg->Evaluate(closure, context);
+    if (value.TryAs<Runtime::String>())
     {
-        actualParams.push_back(arg->Evaluate(closure));
+        return value;
     }
 
-    ObjectHolder calee = m_Object->Evaluate(closure);
-    if (Runtime::ClassInstance* instance = calee.TryAs<Runtime::ClassInstance>())
+    std::string result;
+    Runtime::AppendStr(result, value, context);
+    return ObjectHolder::Own(Runtime::String(std::move(result)));
+}
+
+FormatString::FormatString(std::vector<std::string> literals, std::vector<std::unique_ptr<Node>> holes)
+    : m_Literals(std::move(literals)), m_Holes(std::move(holes))
+{
+    for (const std::string& literal : m_Literals)
     {
-        return instance->Call(m_Method, actualParams);
+        m_Capacity += literal.size();
+    }
+}
+
+ObjectHolder FormatString::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    std::string result;
+    result.reserve(m_Capacity);
+
+    for (size_t i = 0; i < m_Holes.size(); i++)
+    {
+        result.append(m_Literals[i]);
+
+        // Numbers are formatted without being boxed
+        Value value = m_Holes[i]->EvaluateValue(closure, context);
+        if (value.IsInt())
+            Runtime::AppendInt(result, value.GetInt());
+        else if (value.IsFloat())
+            Runtime::AppendFloat(result, value.GetFloat());
+        else
+            Runtime::AppendStr(result, std::move(value).Box(), context);
+    }
+    result.append(m_Literals.back());
+
+    m_Capacity = std::max(m_Capacity, result.size());
+    return ObjectHolder::Own(Runtime::String(std::move(result)));
+}
+
+ObjectHolder OpenFile::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    ObjectHolder path = m_Arg->Evaluate(closure, context);
+    if (const Runtime::String* str = path.TryAs<Runtime::String>())
+    {
+        return ObjectHolder::Make<Runtime::File>(std::string(str->GetValue()));
+    }
+    throw std::runtime_error("open() takes a path string");
+}
+
+ObjectHolder Length::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    ObjectHolder value = m_Arg->Evaluate(closure, context);
+
+    size_t length = 0;
+    if (const Runtime::List* list = value.TryAs<Runtime::List>())
+    {
+        length = list->Size();
+    }
+    else if (const Runtime::Dict* dict = value.TryAs<Runtime::Dict>())
+    {
+        length = dict->Size();
+    }
+    else if (const Runtime::Array* array = value.TryAs<Runtime::Array>())
+    {
+        length = array->Size();
+    }
+    else if (const Runtime::Tuple* tuple = value.TryAs<Runtime::Tuple>())
+    {
+        length = tuple->Size();
+    }
+    else if (const Runtime::String* str = value.TryAs<Runtime::String>())
+    {
+        length = str->GetValue().size();
     }
     else
     {
-        throw std::runtime_error("Trying to call method " + m_Method + " on an object that is not a class instance");
+        throw std::runtime_error("Object has no len()");
     }
+
+    return Runtime::MakeInteger(BigInteger(static_cast<long long>(length)));
 }
 
-ObjectHolder NewInstance::Evaluate(Runtime::Closure& closure)
+ObjectHolder MakeArray::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
 {
-    Runtime::ClassInstance instance(m_Class);
+    ObjectHolder items = m_Items->Evaluate(closure, context);
+    const Runtime::List* list = items.TryAs<Runtime::List>();
+    if (!list)
+    {
+        throw std::runtime_error("array() takes a list");
+    }
 
-    if (const Runtime::Method* m = m_Class.GetMethod("__init__"); m)
+    std::string elementType = "int";
+    if (m_ElementType)
+    {
+        ObjectHolder type = m_ElementType->Evaluate(closure, context);
+        const Runtime::String* name = type.TryAs<Runtime::String>();
+        if (!name)
+        {
+            throw std::runtime_error("Array element type must be a string");
+        }
+        elementType = name->GetValue();
+    }
+
+    return Runtime::Array::FromList(*list, elementType);
+}
+
+ObjectHolder ListLiteral::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    Runtime::Collector::Get().MaybeCollect();
+    ObjectHolder list = ObjectHolder::Make<Runtime::List>();
+
+    for (const auto& item : m_Items)
+    {
+        static_cast<Runtime::List&>(*list).Append(Runtime::DetachSlice(item->Evaluate(closure, context)));
+    }
+    return list;
+}
+
+ObjectHolder TupleLiteral::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    Runtime::Collector::Get().MaybeCollect();
+
+    // Small tuples are built without a temporary heap buffer
+    std::array<ObjectHolder, Runtime::Tuple::InlineCapacity> inlineItems;
+    std::vector<ObjectHolder> heapItems;
+    std::span<ObjectHolder> items(inlineItems.data(), m_Items.size());
+
+    if (m_Items.size() > inlineItems.size())
+    {
+        heapItems.resize(m_Items.size());
+        items = heapItems;
+    }
+
+    for (size_t i = 0; i < m_Items.size(); i++)
+    {
+        items[i] = Runtime::DetachSlice(m_Items[i]->Evaluate(closure, context));
+    }
+    return ObjectHolder::Make<Runtime::Tuple>(items);
+}
+
+ObjectHolder DictLiteral::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    Runtime::Collector::Get().MaybeCollect();
+    ObjectHolder dict = ObjectHolder::Make<Runtime::Dict>();
+
+    for (const auto& [key, value] : m_Items)
+    {
+        ObjectHolder keyObject = Runtime::DetachSlice(key->Evaluate(closure, context));
+        static_cast<Runtime::Dict&>(*dict).Set(std::move(keyObject), Runtime::DetachSlice(value->Evaluate(closure, context)), context);
+    }
+    return dict;
+}
+
+ObjectHolder Membership::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    ObjectHolder item = m_Left->Evaluate(closure, context);
+    ObjectHolder container = m_Right->Evaluate(closure, context);
+
+    switch (Runtime::GetTypeTag(container))
     {
-        std::vector<ObjectHolder> actualParams;
-        for (const auto& arg : m_Args)
+    case Runtime::TypeTag::List:
+        return MakeBool(static_cast<const Runtime::List&>(*container).Contains(item, context));
+    case Runtime::TypeTag::Tuple:
+        return MakeBool(static_cast<const Runtime::Tuple&>(*container).Contains(item, context));
+    case Runtime::TypeTag::Dict:
+        return MakeBool(static_cast<const Runtime::Dict&>(*container).Contains(item, context));
+    case Runtime::TypeTag::String:
+        if (const Runtime::String* str = item.TryAs<Runtime::String>())
+        {
+            std::string_view haystack = static_cast<const Runtime::String&>(*container).GetValue();
+            return MakeBool(Runtime::Kernels::Find(haystack, str->GetValue()) != Runtime::Kernels::NotFound);
+        }
+        throw std::runtime_error("Only strings can be searched for in a string");
+    default:
+        // Consumes a generator up to the item, like a loop over it would
+        if (Runtime::Generator* generator = container.TryAs<Runtime::Generator>())
         {
-            actualParams.push_back(arg->Evaluate(closure));
+            while (std::optional<ObjectHolder> next = generator->Next())
+            {
+                if (Runtime::KeysEqual(*next, item, context))
+                    return MakeBool(true);
+            }
+            return MakeBool(false);
         }
+        throw std::runtime_error("Object is not a container");
+    }
+}
+
+std::unique_ptr<Node> Subscript::MakeAssign(std::unique_ptr<Node> value)
+{
+    return std::make_unique<SubscriptAssign>(std::move(m_Object), std::move(m_Index), std::move(value));
+}
+
+ObjectHolder Subscript::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    ObjectHolder object = m_Object->Evaluate(closure, context);
+    ObjectHolder index = m_Index->Evaluate(closure, context);
+
+    switch (Runtime::GetTypeTag(object))
+    {
+    case Runtime::TypeTag::List:
+        return static_cast<const Runtime::List&>(*object).Get(ToIndex(index));
+    case Runtime::TypeTag::Dict:
+        return static_cast<const Runtime::Dict&>(*object).Get(index, context);
+    case Runtime::TypeTag::Array:
+        return static_cast<const Runtime::Array&>(*object).Get(ToIndex(index));
+    case Runtime::TypeTag::Tuple:
+        return static_cast<const Runtime::Tuple&>(*object).Get(ToIndex(index));
+    case Runtime::TypeTag::String:
+        return static_cast<const Runtime::String&>(*object).Get(ToIndex(index));
+    default:
+        throw std::runtime_error("Object is not subscriptable");
+    }
+}
+
+ObjectHolder Slice::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    ObjectHolder object = m_Object->Evaluate(closure, context);
+
+    // Like Python, negative bounds count from the end and the bounds are
+    // clamped to the size rather than raising
+    auto bounds = [&](size_t size) {
+        auto bound = [&](const std::unique_ptr<Node>& node, size_t missing) {
+            if (!node)
+                return missing;
+
+            long long value = ToIndex(node->Evaluate(closure, context));
+            if (value < 0)
+                value += static_cast<long long>(size);
+            return static_cast<size_t>(std::clamp(value, 0LL, static_cast<long long>(size)));
+        };
+
+        size_t begin = bound(m_Begin, 0);
+        size_t end = bound(m_End, size);
+        return std::pair(begin, std::max(begin, end));
+    };
+
+    switch (Runtime::GetTypeTag(object))
+    {
+    case Runtime::TypeTag::String:
+    {
+        const auto& str = static_cast<const Runtime::String&>(*object);
+        auto [begin, end] = bounds(str.Size());
+        return ObjectHolder::Own(str.Slice(begin, end));
+    }
+    case Runtime::TypeTag::List:
+    {
+        const auto& list = static_cast<const Runtime::List&>(*object);
+        auto [begin, end] = bounds(list.Size());
+        ObjectHolder result = ObjectHolder::Make<Runtime::List>();
+        for (size_t i = begin; i < end; i++)
+        {
+            static_cast<Runtime::List&>(*result).Append(list.Get(static_cast<int>(i)));
+        }
+        return result;
+    }
+    case Runtime::TypeTag::Tuple:
+    {
+        const auto& tuple = static_cast<const Runtime::Tuple&>(*object);
+        auto [begin, end] = bounds(tuple.Size());
+        std::vector<ObjectHolder> items(tuple.GetItems().begin() + begin, tuple.GetItems().begin() + end);
+        return ObjectHolder::Make<Runtime::Tuple>(std::span<ObjectHolder>(items));
+    }
+    default:
+        throw std::runtime_error("Object can't be sliced");
+    }
+}
+
+ObjectHolder SubscriptAssign::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    ObjectHolder object = m_Object->Evaluate(closure, context);
+    ObjectHolder index = m_Index->Evaluate(closure, context);
+    ObjectHolder value = Runtime::DetachSlice(m_Expr->Evaluate(closure, context));
 
-        instance.Call("__init__", actualParams);
+    switch (Runtime::GetTypeTag(object))
+    {
+    case Runtime::TypeTag::List:
+        static_cast<Runtime::List&>(*object).Set(ToIndex(index), value);
+        break;
+    case Runtime::TypeTag::Dict:
+        static_cast<Runtime::Dict&>(*object).Set(Runtime::DetachSlice(std::move(index)), value, context);
+        break;
+    case Runtime::TypeTag::Array:
+        static_cast<Runtime::Array&>(*object).Set(ToIndex(index), value);
+        break;
+    default:
+        throw std::runtime_error("Object does not support item assignment");
     }
+    return value;
+}
+
+ObjectHolder Return::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    ObjectHolder value = m_Node->Evaluate(closure, context);
+    if (!context.IsInterrupted())
+        context.SetReturn(std::move(value));
+    return ObjectHolder::None();
+}
+
+ObjectHolder Break::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    context.SetBreak();
+    return ObjectHolder::None();
+}
+
+ObjectHolder Continue::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    context.SetContinue();
+    return ObjectHolder::None();
+}
 
-    return ObjectHolder::Own(std::move(instance));
+ObjectHolder Raise::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    context.SetRaise(m_Node->Evaluate(closure, context));
+    return ObjectHolder::None();
 }
 
-ObjectHolder Stringify::Evaluate(Runtime::Closure& closure)
+ObjectHolder TryExcept::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
 {
-    ObjectHolder value = m_Arg->Evaluate(closure);
+    try
+    {
+        m_Body->Evaluate(closure, context);
+    }
+    catch (const Runtime::Raised& raised)
+    {
+        context.SetRaise(raised.GetException());
+    }
+    catch (const std::runtime_error& error)
+    {
+        context.SetRaise(ObjectHolder::Own(Runtime::String(error.what())));
+    }
 
-    std::ostringstream os;
-    value->Print(os);
+    if (context.GetCompletion() != Runtime::Completion::Raise)
+        return ObjectHolder::None();
 
-    return ObjectHolder::Own(Runtime::String(os.str()));
+    if (Handler* handler = Catch(closure, context))
+        handler->body->Evaluate(closure, context);
+    return ObjectHolder::None();
 }
 
-ObjectHolder Return::Evaluate(Runtime::Closure& closure)
+bool TryExcept::CanYield() const
 {
-    return m_Node->Evaluate(closure);
+    if (m_Body->CanYield())
+        return true;
+
+    return std::any_of(m_Handlers.begin(), m_Handlers.end(), [](const Handler& handler) {
+        return handler.body->CanYield();
+    });
 }
 
-ObjectHolder ClassDefinition::Evaluate(Runtime::Closure& closure)
+Execution TryExcept::Execute(Runtime::Closure& closure, Runtime::Context& context)
+{
+    // Handlers can't be awaited inside of catch blocks
+    try
+    {
+        co_await Step(*m_Body, closure, context);
+    }
+    catch (const Runtime::Raised& raised)
+    {
+        context.SetRaise(raised.GetException());
+    }
+    catch (const std::runtime_error& error)
+    {
+        context.SetRaise(ObjectHolder::Own(Runtime::String(error.what())));
+    }
+
+    if (context.GetCompletion() != Runtime::Completion::Raise)
+        co_return;
+
+    if (Handler* handler = Catch(closure, context))
+        co_await Step(*handler->body, closure, context);
+}
+
+TryExcept::Handler* TryExcept::Catch(Runtime::Closure& closure, Runtime::Context& context)
+{
+    ObjectHolder exception = context.TakeException();
+    for (Handler& handler : m_Handlers)
+    {
+        if (handler.cls && !IsInstanceOf(exception, *handler.cls))
+            continue;
+
+        if (!handler.varName.empty())
+            closure[handler.varName] = std::move(exception);
+        return &handler;
+    }
+
+    context.SetRaise(std::move(exception));
+    return nullptr;
+}
+
+ObjectHolder Yield::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    throw std::runtime_error("yield outside of a generator");
+}
+
+Execution Yield::Execute(Runtime::Closure& closure, Runtime::Context& context)
+{
+    // Named, since GCC 12 destroys the value of a temporary awaiter twice
+    YieldAwaiter yield{m_Node->Evaluate(closure, context)};
+    co_await yield;
+}
+
+ObjectHolder GeneratorBody::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    // The closure of the call moves into the generator, the call returns
+    // the generator as its result
+    context.SetReturn(ObjectHolder::Make<Runtime::Generator>(std::move(closure), *m_Body));
+    return ObjectHolder::None();
+}
+
+ObjectHolder While::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    while (Runtime::IsTrue(m_Condition->Evaluate(closure, context)))
+    {
+        m_Body->Evaluate(closure, context);
+
+        if (LeavesLoop(context))
+            break;
+    }
+    return ObjectHolder::None();
+}
+
+Execution While::Execute(Runtime::Closure& closure, Runtime::Context& context)
+{
+    while (Runtime::IsTrue(m_Condition->Evaluate(closure, context)))
+    {
+        co_await Step(*m_Body, closure, context);
+
+        if (LeavesLoop(context))
+            break;
+    }
+}
+
+ObjectHolder ForRange::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    int start = m_Start ? ToRangeBound(m_Start->EvaluateValue(closure, context)) : 0;
+    int stop = ToRangeBound(m_Stop->EvaluateValue(closure, context));
+    int step = m_Step ? ToRangeBound(m_Step->EvaluateValue(closure, context)) : 1;
+
+    if (step == 0)
+        throw std::runtime_error("range() step must not be zero");
+
+    // References to the values of the closure survive its rehashing, so the
+    // variable is looked up once rather than on every iteration
+    ObjectHolder* var = nullptr;
+
+    for (long long i = start; step > 0 ? i < stop : i > stop; i += step)
+    {
+        if (!var)
+            var = &closure[m_VarName];
+
+        *var = ObjectHolder::Own(Runtime::Number(static_cast<int>(i)));
+        m_Body->Evaluate(closure, context);
+
+        if (LeavesLoop(context))
+            break;
+    }
+    return ObjectHolder::None();
+}
+
+Execution ForRange::Execute(Runtime::Closure& closure, Runtime::Context& context)
+{
+    int start = m_Start ? ToRangeBound(m_Start->EvaluateValue(closure, context)) : 0;
+    int stop = ToRangeBound(m_Stop->EvaluateValue(closure, context));
+    int step = m_Step ? ToRangeBound(m_Step->EvaluateValue(closure, context)) : 1;
+
+    if (step == 0)
+        throw std::runtime_error("range() step must not be zero");
+
+    ObjectHolder* var = nullptr;
+    for (long long i = start; step > 0 ? i < stop : i > stop; i += step)
+    {
+        if (!var)
+            var = &closure[m_VarName];
+
+        *var = ObjectHolder::Own(Runtime::Number(static_cast<int>(i)));
+        co_await Step(*m_Body, closure, context);
+
+        if (LeavesLoop(context))
+            break;
+    }
+}
+
+ObjectHolder ForEach::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    Iteration items(m_Container->Evaluate(closure, context));
+    while (std::optional<ObjectHolder> item = items.Next())
+    {
+        closure[m_VarName] = std::move(*item);
+        m_Body->Evaluate(closure, context);
+
+        if (LeavesLoop(context))
+            break;
+    }
+    return ObjectHolder::None();
+}
+
+Execution ForEach::Execute(Runtime::Closure& closure, Runtime::Context& context)
+{
+    Iteration items(m_Container->Evaluate(closure, context));
+    while (std::optional<ObjectHolder> item = items.Next())
+    {
+        closure[m_VarName] = std::move(*item);
+        co_await Step(*m_Body, closure, context);
+
+        if (LeavesLoop(context))
+            break;
+    }
+}
+
+ObjectHolder ClassDefinition::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
 {
     closure[m_ClassName] = m_Class;
     return ObjectHolder::None();
 }
 
-ObjectHolder IfElse::Evaluate(Runtime::Closure& closure)
+ObjectHolder FunctionDefinition::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    closure[static_cast<const Runtime::Function&>(*m_Function).GetName()] = m_Function;
+    return ObjectHolder::None();
+}
+
+ObjectHolder IfElse::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
 {
-    ObjectHolder value = m_Condition->Evaluate(closure);
+    ObjectHolder value = m_Condition->Evaluate(closure, context);
     if (Runtime::IsTrue(value))
     {
-        m_IfBody->Evaluate(closure);
+        m_IfBody->Evaluate(closure, context);
     }
     else if (m_ElseBody)
     {
-        m_ElseBody->Evaluate(closure);
+        m_ElseBody->Evaluate(closure, context);
     }
     return ObjectHolder::None();
 }
 
-ObjectHolder Comparison::Evaluate(Runtime::Closure& closure)
+Execution IfElse::Execute(Runtime::Closure& closure, Runtime::Context& context)
 {
-    return ObjectHolder::Own(
-        Runtime::Bool(m_Comparator(m_Left->Evaluate(closure), m_Right->Evaluate(closure)))
-    );
+    if (Runtime::IsTrue(m_Condition->Evaluate(closure, context)))
+    {
+        co_await Step(*m_IfBody, closure, context);
+    }
+    else if (m_ElseBody)
+    {
+        co_await Step(*m_ElseBody, closure, context);
+    }
+}
+
+ObjectHolder Comparison::Evaluate(Runtime::Closure& closure, Runtime::Context& context)
+{
+    Value left = m_Left->EvaluateValue(closure, context);
+    Value right = m_Right->EvaluateValue(closure, context);
+
+    if (left.IsInt() && right.IsInt())
+    {
+        return MakeBool(Runtime::Satisfies(left.GetInt() <=> right.GetInt(), m_Op));
+    }
+
+    if (left.IsNumeric() && right.IsNumeric())
+    {
+        return MakeBool(Runtime::Satisfies(left.ToDouble() <=> right.ToDouble(), m_Op));
+    }
+
+    ObjectHolder lhs = std::move(left).Box();
+    ObjectHolder rhs = std::move(right).Box();
+
+    // Arrays compare element-wise into masks
+    if (lhs && rhs && (Runtime::GetTypeTag(lhs) == Runtime::TypeTag::Array || Runtime::GetTypeTag(rhs) == Runtime::TypeTag::Array))
+    {
+        return Runtime::CompareElements(m_Op, *lhs, *rhs);
+    }
+
+    return MakeBool(Runtime::Compare(lhs, rhs, m_Op, context));
 }
 
 }
@@ -1,19 +1,197 @@
 #pragma once
 
+#include <array>
 #include <memory>
 #include <vector>
 #include <functional>
 #include "token.h"
 #include "object.h"
 #include "object_holder.h"
+#include "context.h"
+#include "comparators.h"
+#include "dict.h"
+#include "array.h"
+#include "output_sink.h"
+#include "file.h"
+#include "execution.h"
 
 namespace AST {
 
+// Result of an arithmetic subexpression. Ints and floats computed by the
+// arithmetic nodes stay unboxed until they leave arithmetic, so a * b + c
+// only allocates the object of the final result.
+class Value
+{
+public:
+    static Value FromInt(int value)
+    {
+        Value result(Kind::Int);
+        result.m_Int = value;
+        return result;
+    }
+
+    static Value FromFloat(double value)
+    {
+        Value result(Kind::Float);
+        result.m_Float = value;
+        return result;
+    }
+
+    // Numbers and Floats are unboxed, but keep their object so that they
+    // aren't boxed again
+    static Value FromObject(ObjectHolder object)
+    {
+        Value result(Kind::Object);
+        switch (Runtime::GetTypeTag(object))
+        {
+        case Runtime::TypeTag::Number:
+            result.m_Kind = Kind::Int;
+            result.m_Int = static_cast<const Runtime::Number&>(*object).GetValue();
+            break;
+        case Runtime::TypeTag::Float:
+            result.m_Kind = Kind::Float;
+            result.m_Float = static_cast<const Runtime::Float&>(*object).GetValue();
+            break;
+        default:
+            break;
+        }
+        result.m_Object = std::move(object);
+        return result;
+    }
+
+    bool IsInt() const
+    {
+        return m_Kind == Kind::Int;
+    }
+
+    bool IsFloat() const
+    {
+        return m_Kind == Kind::Float;
+    }
+
+    bool IsNumeric() const
+    {
+        return m_Kind != Kind::Object;
+    }
+
+    int GetInt() const
+    {
+        return m_Int;
+    }
+
+    double GetFloat() const
+    {
+        return m_Float;
+    }
+
+    double ToDouble() const
+    {
+        return IsFloat() ? m_Float : m_Int;
+    }
+
+    ObjectHolder Box() &&
+    {
+        if (m_Object || m_Kind == Kind::Object)
+            return std::move(m_Object);
+
+        if (m_Kind == Kind::Int)
+            return ObjectHolder::Own(Runtime::Number(m_Int));
+
+        return ObjectHolder::Own(Runtime::Float(m_Float));
+    }
+private:
+    enum class Kind
+    {
+        Int,
+        Float,
+        Object,
+    };
+
+    explicit Value(Kind kind)
+        : m_Kind(kind)
+    {
+    }
+
+    Kind m_Kind;
+    int m_Int = 0;
+    double m_Float = 0;
+    ObjectHolder m_Object;
+};
+
 class Node
 {
 public:
     virtual ~Node() = default;
-    virtual ObjectHolder Evaluate(Runtime::Closure& closure) = 0;
+    virtual ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) = 0;
+
+    // Overridden by the nodes that can produce numbers without boxing them
+    virtual Value EvaluateValue(Runtime::Closure& closure, Runtime::Context& context)
+    {
+        return Value::FromObject(Evaluate(closure, context));
+    }
+
+    // Statements with a yield inside of them run as coroutines in generator
+    // bodies, everything else is evaluated as usual even there
+    virtual bool CanYield() const
+    {
+        return false;
+    }
+
+    virtual Execution Execute(Runtime::Closure& closure, Runtime::Context& context);
+
+    // Called by the statements that stop on a raise left in the context.
+    // Calls right under them leave the raises of the callees there, while
+    // calls nested in expressions throw them to skip the rest of the
+    // expression.
+    virtual void LeaveRaiseInContext()
+    {
+    }
+
+    // The assignment of the value to what the node reads, for the nodes
+    // that can be assigned to. Takes the parts of the node, which is
+    // discarded after it, nullptr for the other nodes.
+    virtual std::unique_ptr<Node> MakeAssign(std::unique_ptr<Node> value)
+    {
+        return nullptr;
+    }
+};
+
+// Awaited by the executions of statements to run the statements inside of
+// them. Those that can't yield are evaluated right away without a frame of
+// their own, the others are switched to as children.
+class Step
+{
+public:
+    Step(Node& node, Runtime::Closure& closure, Runtime::Context& context)
+        : m_Node(node), m_Closure(closure), m_Context(context)
+    {
+    }
+
+    bool await_ready()
+    {
+        if (m_Node.CanYield())
+            return false;
+
+        m_Node.Evaluate(m_Closure, m_Context);
+        return true;
+    }
+
+    std::coroutine_handle<> await_suspend(Execution::Handle parent)
+    {
+        m_Child.emplace(m_Node.Execute(m_Closure, m_Context));
+        return m_Child->AttachTo(parent);
+    }
+
+    void await_resume()
+    {
+        if (m_Child)
+            m_Child->RethrowException();
+    }
+private:
+    Node& m_Node;
+    Runtime::Closure& m_Closure;
+    Runtime::Context& m_Context;
+    std::optional<Execution> m_Child;
 };
 
 template<typename T>
@@ -21,21 +199,23 @@ class ValueNode : public Node
 {
 public:
     ValueNode(T value)
-        : m_Value(std::move(value))
+        : m_Value(ObjectHolder::Own(std::move(value)))
     {
     }
 
-    ObjectHolder Evaluate(Runtime::Closure& closure) override {
-        return ObjectHolder::Share(m_Value);
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override {
+        return m_Value;
     }
 
 private:
-    T m_Value;
+    ObjectHolder m_Value;
 };
 
 using NumericConst = ValueNode<Runtime::Number>;
+using BigIntConst = ValueNode<Runtime::BigInt>;
 using StringConst = ValueNode<Runtime::String>;
 using BoolConst = ValueNode<Runtime::Bool>;
+using FloatConst = ValueNode<Runtime::Float>;
 
 class VariableValue : public Node
 {
@@ -50,11 +230,27 @@ public:
     {
     }
 
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
 private:
     std::vector<std::string> m_DottedIds;
 };
 
+// object.name for objects other than variables, like xs[0].name
+class FieldValue : public Node
+{
+public:
+    FieldValue(std::unique_ptr<Node> object, std::string fieldName)
+        : m_Object(std::move(object)), m_FieldName(std::move(fieldName))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+    std::unique_ptr<Node> MakeAssign(std::unique_ptr<Node> value) override;
+private:
+    std::unique_ptr<Node> m_Object;
+    std::string m_FieldName;
+};
+
 class BinaryOp : public Node
 {
 public:
@@ -67,46 +263,43 @@ protected:
     std::unique_ptr<Node> m_Left, m_Right;
 };
 
-class Add : public BinaryOp
-{
-public:
-    using BinaryOp::BinaryOp;
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
-};
-
-class Sub : public BinaryOp
+enum class ArithmeticOp
 {
-public:
-    using BinaryOp::BinaryOp;
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    Add,
+    Sub,
+    Mul,
+    Div,
 };
 
-class Mul : public BinaryOp
+// Finds the implementation for the types of both operands in a table
+// indexed by their type tags, generated at compile time from the operand
+// type pairs the operation is defined for
+template <ArithmeticOp Op>
+class Arithmetic : public BinaryOp
 {
 public:
     using BinaryOp::BinaryOp;
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+    Value EvaluateValue(Runtime::Closure& closure, Runtime::Context& context) override;
 };
 
-class Div : public BinaryOp
-{
-public:
-    using BinaryOp::BinaryOp;
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
-};
+using Add = Arithmetic<ArithmeticOp::Add>;
+using Sub = Arithmetic<ArithmeticOp::Sub>;
+using Mul = Arithmetic<ArithmeticOp::Mul>;
+using Div = Arithmetic<ArithmeticOp::Div>;
 
 class And : public BinaryOp
 {
 public:
     using BinaryOp::BinaryOp;
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
 };
 
 class Or : public BinaryOp
 {
 public:
     using BinaryOp::BinaryOp;
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
 };
 
 class UnaryOp : public Node
@@ -123,19 +316,21 @@ protected:
 class Negate : public UnaryOp
 {
     using UnaryOp::UnaryOp;
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+    Value EvaluateValue(Runtime::Closure& closure, Runtime::Context& context) override;
 };
 
 class Positive : public UnaryOp
 {
     using UnaryOp::UnaryOp;
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+    Value EvaluateValue(Runtime::Closure& closure, Runtime::Context& context) override;
 };
 
 class Not : public UnaryOp
 {
     using UnaryOp::UnaryOp;
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
 };
 
 class Compound : public Node
@@ -144,17 +339,27 @@ public:
     template<typename ...Args>
     Compound(Args&& ...args)
     {
-        (m_Nodes.push_back(std::forward<Args>(args)), ...);
+        (Add(std::forward<Args>(args)), ...);
     }
 
     void Add(std::unique_ptr<Node> node)
     {
+        node->LeaveRaiseInContext();
+        m_CanYield = m_CanYield || node->CanYield();
         m_Nodes.push_back(std::move(node));
     }
 
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+
+    bool CanYield() const override
+    {
+        return m_CanYield;
+    }
+
+    Execution Execute(Runtime::Closure& closure, Runtime::Context& context) override;
 private:
     std::vector<std::unique_ptr<Node>> m_Nodes;
+    bool m_CanYield = false;
 };
 
 class Assign : public Node
@@ -163,32 +368,48 @@ public:
     Assign(std::string varName, std::unique_ptr<AST::Node> expr)
         : m_VarName(std::move(varName)), m_Expr(std::move(expr))
     {
+        m_Expr->LeaveRaiseInContext();
     }
 
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
 private:
     std::string m_VarName;
     std::unique_ptr<AST::Node> m_Expr;
 };
 
+// a, b = value, for tuples and lists of matching size
+class UnpackAssign : public Node
+{
+public:
+    UnpackAssign(std::vector<std::string> varNames, std::unique_ptr<AST::Node> expr)
+        : m_VarNames(std::move(varNames)), m_Expr(std::move(expr))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    std::vector<std::string> m_VarNames;
+    std::unique_ptr<AST::Node> m_Expr;
+};
+
 class FieldAssign : public Node
 {
 public:
-    FieldAssign(std::unique_ptr<VariableValue> object, std::string fieldName, std::unique_ptr<Node> expr)
+    FieldAssign(std::unique_ptr<Node> object, std::string fieldName, std::unique_ptr<Node> expr)
         : m_Object(std::move(object)), m_FieldName(std::move(fieldName)), m_Expr(std::move(expr))
     {
     }
 
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
 private:
-    std::unique_ptr<VariableValue> m_Object;
+    std::unique_ptr<Node> m_Object;
     std::string m_FieldName;
     std::unique_ptr<Node> m_Expr;
 };
 
 struct None : Node
 {
-    ObjectHolder Evaluate(Runtime::Closure& closure) override
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override
     {
         return ObjectHolder::None();
     }
@@ -209,12 +430,15 @@ public:
 
     static std::unique_ptr<Print> Variable(std::string name);
 
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
 
+    // Standard output unless replaced
+    static Runtime::OutputSink& GetOutput();
+    static void SetOutput(std::unique_ptr<Runtime::OutputSink> output);
     static void SetOutputStream(std::ostream& os);
 private:
     std::vector<std::unique_ptr<Node>> m_Args;
-    static std::ostream* s_Output;
+    static std::unique_ptr<Runtime::OutputSink> s_Output;
 };
 
 class MethodCall : public Node
@@ -225,11 +449,31 @@ public:
     {
     }
 
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+
+    void LeaveRaiseInContext() override
+    {
+        m_LeaveRaise = true;
+    }
 private:
+    const Runtime::Method* LookupMethod(const Runtime::Class& cls);
+
+    // Polymorphic inline cache of methods already resolved at this call site.
+    // Once it's full the call site is megamorphic and goes to the class VMT.
+    struct CacheEntry
+    {
+        const Runtime::Class* cls = nullptr;
+        const Runtime::Method* method = nullptr;
+    };
+
+    static constexpr size_t CacheSize = 4;
+
     std::unique_ptr<Node> m_Object;
     std::string m_Method;
     std::vector<std::unique_ptr<Node>> m_Args;
+    std::array<CacheEntry, CacheSize> m_Cache;
+    size_t m_CacheSize = 0;
+    bool m_LeaveRaise = false;
 };
 
 class NewInstance : public Node
@@ -245,17 +489,188 @@ public:
     {
     }
 
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+
+    void LeaveRaiseInContext() override
+    {
+        m_LeaveRaise = true;
+    }
 private:
     const Runtime::Class& m_Class;
     std::vector<std::unique_ptr<Node>> m_Args;
+    bool m_LeaveRaise = false;
+};
+
+// Call of a module-level function, bound to the function by the parser
+class FunctionCall : public Node
+{
+public:
+    FunctionCall(const Runtime::Function& function, std::vector<std::unique_ptr<Node>> args)
+        : m_Function(function), m_Args(std::move(args))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+
+    void LeaveRaiseInContext() override
+    {
+        m_LeaveRaise = true;
+    }
+private:
+    const Runtime::Function& m_Function;
+    std::vector<std::unique_ptr<Node>> m_Args;
+    bool m_LeaveRaise = false;
 };
 
 class Stringify : public UnaryOp
 {
 public:
     using UnaryOp::UnaryOp;
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+};
+
+// f"...{expr}...", the literals around the holes are kept as they were
+// lexed. The result is built in one buffer, reserved for the size the
+// previous evaluation ended up with.
+class FormatString : public Node
+{
+public:
+    FormatString(std::vector<std::string> literals, std::vector<std::unique_ptr<Node>> holes);
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    std::vector<std::string> m_Literals;
+    std::vector<std::unique_ptr<Node>> m_Holes;
+    size_t m_Capacity = 0;
+};
+
+// Built-in len(x) of lists, dicts, arrays and strings
+class Length : public UnaryOp
+{
+public:
+    using UnaryOp::UnaryOp;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+};
+
+// Built-in open(path), which opens the file for reading
+class OpenFile : public UnaryOp
+{
+public:
+    using UnaryOp::UnaryOp;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+};
+
+// Built-in array(list) and array(list, elementType)
+class MakeArray : public Node
+{
+public:
+    MakeArray(std::unique_ptr<Node> items, std::unique_ptr<Node> elementType)
+        : m_Items(std::move(items)), m_ElementType(std::move(elementType))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    std::unique_ptr<Node> m_Items;
+    std::unique_ptr<Node> m_ElementType;
+};
+
+class ListLiteral : public Node
+{
+public:
+    ListLiteral(std::vector<std::unique_ptr<Node>> items)
+        : m_Items(std::move(items))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    std::vector<std::unique_ptr<Node>> m_Items;
+};
+
+class DictLiteral : public Node
+{
+public:
+    using Item = std::pair<std::unique_ptr<Node>, std::unique_ptr<Node>>;
+
+    DictLiteral(std::vector<Item> items)
+        : m_Items(std::move(items))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    std::vector<Item> m_Items;
+};
+
+class TupleLiteral : public Node
+{
+public:
+    TupleLiteral(std::vector<std::unique_ptr<Node>> items)
+        : m_Items(std::move(items))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    std::vector<std::unique_ptr<Node>> m_Items;
+};
+
+// item in container, for lists, tuples, dicts and substrings of strings
+class Membership : public BinaryOp
+{
+public:
+    using BinaryOp::BinaryOp;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+};
+
+// object[index]
+class Subscript : public Node
+{
+public:
+    Subscript(std::unique_ptr<Node> object, std::unique_ptr<Node> index)
+        : m_Object(std::move(object)), m_Index(std::move(index))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+    std::unique_ptr<Node> MakeAssign(std::unique_ptr<Node> value) override;
+private:
+    std::unique_ptr<Node> m_Object;
+    std::unique_ptr<Node> m_Index;
+};
+
+// object[begin:end], either bound may be missing. Slices of strings share
+// the buffer of the string, slices of lists and tuples are copies.
+class Slice : public Node
+{
+public:
+    Slice(std::unique_ptr<Node> object, std::unique_ptr<Node> begin, std::unique_ptr<Node> end)
+        : m_Object(std::move(object)), m_Begin(std::move(begin)), m_End(std::move(end))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    std::unique_ptr<Node> m_Object;
+    std::unique_ptr<Node> m_Begin;
+    std::unique_ptr<Node> m_End;
+};
+
+// object[index] = expr
+class SubscriptAssign : public Node
+{
+public:
+    SubscriptAssign(std::unique_ptr<Node> object, std::unique_ptr<Node> index, std::unique_ptr<Node> expr)
+        : m_Object(std::move(object)), m_Index(std::move(index)), m_Expr(std::move(expr))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    std::unique_ptr<Node> m_Object;
+    std::unique_ptr<Node> m_Index;
+    std::unique_ptr<Node> m_Expr;
 };
 
 class Return : public Node
@@ -264,27 +679,215 @@ public:
     Return(std::unique_ptr<Node> node)
         : m_Node(std::move(node))
     {
+        m_Node->LeaveRaiseInContext();
     }
 
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
 private:
     std::unique_ptr<Node> m_Node;
 };
 
+class Break : public Node
+{
+public:
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+};
+
+class Continue : public Node
+{
+public:
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+};
+
+// raise expr, any value can be raised
+class Raise : public Node
+{
+public:
+    Raise(std::unique_ptr<Node> node)
+        : m_Node(std::move(node))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    std::unique_ptr<Node> m_Node;
+};
+
+// try: ... except Class as name: ... The first handler whose class the
+// raised instance has, or derives from, handles the raise. Handlers without
+// a class handle everything, including the runtime errors of the
+// interpreter, which are raised as strings with their messages.
+class TryExcept : public Node
+{
+public:
+    struct Handler
+    {
+        const Runtime::Class* cls = nullptr;
+        std::string varName;
+        std::unique_ptr<Node> body;
+    };
+
+    TryExcept(std::unique_ptr<Node> body, std::vector<Handler> handlers)
+        : m_Body(std::move(body)), m_Handlers(std::move(handlers))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+
+    bool CanYield() const override;
+    Execution Execute(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    // Takes the raise out of the context and binds it for the handler, or
+    // leaves it there if no handler is for it
+    Handler* Catch(Runtime::Closure& closure, Runtime::Context& context);
+
+    std::unique_ptr<Node> m_Body;
+    std::vector<Handler> m_Handlers;
+};
+
+// yield expr, a statement of the bodies of generators
+class Yield : public Node
+{
+public:
+    Yield(std::unique_ptr<Node> node)
+        : m_Node(std::move(node))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+
+    bool CanYield() const override
+    {
+        return true;
+    }
+
+    Execution Execute(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    std::unique_ptr<Node> m_Node;
+};
+
+// Body of a method or a function with a yield in it. Instead of running the
+// body, a call returns a generator that runs it in the closure of the call.
+class GeneratorBody : public Node
+{
+public:
+    GeneratorBody(std::unique_ptr<Node> body)
+        : m_Body(std::move(body))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    std::unique_ptr<Node> m_Body;
+};
+
+class While : public Node
+{
+public:
+    While(std::unique_ptr<Node> condition, std::unique_ptr<Node> body)
+        : m_Condition(std::move(condition)), m_Body(std::move(body))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+
+    bool CanYield() const override
+    {
+        return m_Body->CanYield();
+    }
+
+    Execution Execute(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    std::unique_ptr<Node> m_Condition;
+    std::unique_ptr<Node> m_Body;
+};
+
+// for name in range(start, stop, step). The bounds are evaluated once and
+// the counter is a C++ int, so the loop itself never touches an object;
+// only the variable the body sees is rebound to each value.
+class ForRange : public Node
+{
+public:
+    ForRange(
+        std::string varName,
+        std::unique_ptr<Node> start,
+        std::unique_ptr<Node> stop,
+        std::unique_ptr<Node> step,
+        std::unique_ptr<Node> body
+    )
+        : m_VarName(std::move(varName)), m_Start(std::move(start)), m_Stop(std::move(stop)),
+          m_Step(std::move(step)), m_Body(std::move(body))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+
+    bool CanYield() const override
+    {
+        return m_Body->CanYield();
+    }
+
+    Execution Execute(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    std::string m_VarName;
+    std::unique_ptr<Node> m_Start;
+    std::unique_ptr<Node> m_Stop;
+    std::unique_ptr<Node> m_Step;
+    std::unique_ptr<Node> m_Body;
+};
+
+// for name in container, over lists, tuples, dict keys and the characters
+// of strings
+class ForEach : public Node
+{
+public:
+    ForEach(std::string varName, std::unique_ptr<Node> container, std::unique_ptr<Node> body)
+        : m_VarName(std::move(varName)), m_Container(std::move(container)), m_Body(std::move(body))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+
+    bool CanYield() const override
+    {
+        return m_Body->CanYield();
+    }
+
+    Execution Execute(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    std::string m_VarName;
+    std::unique_ptr<Node> m_Container;
+    std::unique_ptr<Node> m_Body;
+};
+
 class ClassDefinition : public Node
 {
 public:
     ClassDefinition(ObjectHolder cls)
-        : m_Class(std::move(cls)), m_ClassName(dynamic_cast<const Runtime::Class&>(*cls).GetName())
+        : m_Class(std::move(cls)), m_ClassName(dynamic_cast<const Runtime::Class&>(*m_Class).GetName())
     {
     }
 
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
 private:
     ObjectHolder m_Class;
     std::string m_ClassName;
 };
 
+// Binds the name of a function, so that it can be used as a value
+class FunctionDefinition : public Node
+{
+public:
+    FunctionDefinition(ObjectHolder function)
+        : m_Function(std::move(function))
+    {
+    }
+
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+private:
+    ObjectHolder m_Function;
+};
+
 class IfElse : public Node
 {
 public:
@@ -297,7 +900,14 @@ public:
     {
     }
 
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
+
+    bool CanYield() const override
+    {
+        return m_IfBody->CanYield() || (m_ElseBody && m_ElseBody->CanYield());
+    }
+
+    Execution Execute(Runtime::Closure& closure, Runtime::Context& context) override;
 private:
     std::unique_ptr<Node> m_Condition;
     std::unique_ptr<Node> m_IfBody;
@@ -307,20 +917,18 @@ private:
 class Comparison : public Node
 {
 public:
-    using Comparator = std::function<bool(const ObjectHolder&, const ObjectHolder&)>;
-
     Comparison(
-        Comparator cmp,
+        Runtime::CompareOp op,
         std::unique_ptr<Node> lhs,
         std::unique_ptr<Node> rhs
     )
-        : m_Comparator(std::move(cmp)), m_Left(std::move(lhs)), m_Right(std::move(rhs))
+        : m_Op(op), m_Left(std::move(lhs)), m_Right(std::move(rhs))
     {
     }
 
-    ObjectHolder Evaluate(Runtime::Closure& closure) override;
+    ObjectHolder Evaluate(Runtime::Closure& closure, Runtime::Context& context) override;
 private:
-    Comparator m_Comparator;
+    Runtime::CompareOp m_Op;
     std::unique_ptr<Node> m_Left;
     std::unique_ptr<Node> m_Right;
 };
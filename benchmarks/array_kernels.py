@@ -0,0 +1,22 @@
+# Element-wise arithmetic, masks and reductions over 65536-element arrays,
+# 1024 times. Run with --no-simd to compare against the scalar kernels.
+class Bench:
+  def Fill(xs, lo, n):
+    if n == 1:
+      xs.append(lo - 30000)
+      return None
+    half = n / 2
+    self.Fill(xs, lo, half)
+    self.Fill(xs, lo + half, n - half)
+  def Repeat(a, f, times):
+    if times == 1:
+      g = (f * 2 + f) * f - f
+      return (a * a + a * 3 - 7).sum() + a.dot(a) + (a > 0).sum() + a.max() - a.min() + (g > f).sum()
+    half = times / 2
+    return self.Repeat(a, f, half) + self.Repeat(a, f, times - half)
+bench = Bench()
+xs = []
+bench.Fill(xs, 0, 65536)
+a = array(xs)
+f = array(xs, "float")
+print(bench.Repeat(a, f, 1024))
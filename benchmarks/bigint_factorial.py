@@ -0,0 +1,13 @@
+# 30000! through a balanced product tree, so most of the time goes to
+# multiplying big operands of similar size, then reduced by a prime to
+# exercise big division. Checks that long int arithmetic stays fast.
+class Factorial:
+  def Product(low, high):
+    if low == high:
+      return low
+    middle = (low + high) / 2
+    return self.Product(low, middle) * self.Product(middle + 1, high)
+factorial = Factorial()
+f = factorial.Product(1, 30000)
+p = 1000000007
+print(f - f / p * p)
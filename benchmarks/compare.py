@@ -0,0 +1,24 @@
+# Sorting-style comparisons: every leaf of the recursion compares two
+# instances with > and <=, which used to take up to two user method calls
+# each, and the recursion itself compares numbers with >.
+class Version:
+  def __init__(major, minor):
+    self.major = major
+    self.minor = minor
+  def __lt__(other):
+    if self.major == other.major:
+      return self.minor < other.minor
+    return self.major < other.major
+  def __eq__(other):
+    return self.major == other.major and self.minor == other.minor
+class Sorter:
+  def Run(a, b, n):
+    if n > 0:
+      return self.Run(a, b, n - 1) + self.Run(b, a, n - 1)
+    if a > b:
+      return 1
+    if a <= b:
+      return 0
+    return 100
+sorter = Sorter()
+print(sorter.Run(Version(1, 2), Version(1, 3), 16))
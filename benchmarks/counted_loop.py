@@ -0,0 +1,10 @@
+# A counted loop over a numeric body: the loop control stays in C++ ints,
+# only the variable the body reads is rebound. The same computation as a
+# method recursion would run out of stack long before this count.
+count = 0
+acc = 0.0
+for i in range(3000000):
+  if i - i / 7 * 7 == 0:
+    count = count + 1
+  acc = acc + i * 0.5
+print(count, acc)
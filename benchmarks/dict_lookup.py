@@ -0,0 +1,27 @@
+# Looks up 4096 string keys 64 times each. The keys are built once, so
+# each lookup reuses the hash cached in the key and doesn't allocate.
+class Table:
+  def Fill(d, keys, lo, n):
+    if n == 1:
+      key = "key" + str(lo)
+      keys.append(key)
+      d[key] = lo
+      return None
+    half = n / 2
+    self.Fill(d, keys, lo, half)
+    self.Fill(d, keys, lo + half, n - half)
+  def Sum(d, keys, lo, n):
+    if n == 1:
+      return d[keys[lo]]
+    half = n / 2
+    return self.Sum(d, keys, lo, half) + self.Sum(d, keys, lo + half, n - half)
+  def Repeat(d, keys, times):
+    if times == 1:
+      return self.Sum(d, keys, 0, len(keys))
+    half = times / 2
+    return self.Repeat(d, keys, half) + self.Repeat(d, keys, times - half)
+table = Table()
+d = {}
+keys = []
+table.Fill(d, keys, 0, 4096)
+print(len(d), table.Repeat(d, keys, 64))
@@ -0,0 +1,17 @@
+# Early-return-heavy methods: every call leaves through one of several
+# return statements nested in if/else blocks, about 2^18 calls in total.
+class Classifier:
+  def Sign(n):
+    if n < 0:
+      return 0 - 1
+    if n == 0:
+      return 0
+    return 1
+  def Run(n):
+    if n == 0:
+      if self.Sign(n) == 0:
+        return self.Sign(1) + self.Sign(0 - 1) + 1
+      return 0
+    return self.Run(n - 1) + self.Run(n - 1)
+c = Classifier()
+print(c.Run(16))
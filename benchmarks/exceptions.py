@@ -0,0 +1,25 @@
+# Lookups where half of the keys miss and the misses are raised. The call
+# is right under the assignment, so the raise reaches the try statement as
+# a completion in the context and is never thrown as a C++ exception.
+class Missing:
+  def __init__(key):
+    self.key = key
+class Store:
+  def __init__():
+    self.items = {}
+  def Get(key):
+    if key in self.items:
+      return self.items[key]
+    raise Missing(key)
+store = Store()
+for i in range(1000):
+  store.items[i * 2] = i
+hits = 0
+misses = 0
+for n in range(1000000):
+  try:
+    value = store.Get(n - n / 2000 * 2000)
+    hits = hits + 1
+  except Missing:
+    misses = misses + 1
+print(hits, misses)
@@ -0,0 +1,25 @@
+# The lookups of exceptions.py with the call nested in an expression, so
+# that every raise is thrown as a C++ exception to skip the rest of the
+# expression.
+class Missing:
+  def __init__(key):
+    self.key = key
+class Store:
+  def __init__():
+    self.items = {}
+  def Get(key):
+    if key in self.items:
+      return self.items[key]
+    raise Missing(key)
+store = Store()
+for i in range(1000):
+  store.items[i * 2] = i
+hits = 0
+misses = 0
+for n in range(1000000):
+  try:
+    value = 0 + store.Get(n - n / 2000 * 2000)
+    hits = hits + 1
+  except Missing:
+    misses = misses + 1
+print(hits, misses)
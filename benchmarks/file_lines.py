@@ -0,0 +1,13 @@
+# Line throughput of reading a large file. Generate the input first, e.g.
+#   yes "2024-01-01,sensor-17,OK,42" | head -c 2G > /tmp/lines.csv
+# Regular files are mapped and the lines are slices of the mapping; pipe
+# the file through cat and open("/dev/stdin") to measure the block reader.
+lines = 0
+size = 0
+errors = 0
+for line in open("/tmp/lines.csv"):
+  lines = lines + 1
+  size = size + len(line)
+  if line.startswith("2024-01-01,sensor-17,ERR"):
+    errors = errors + 1
+print(lines, size, errors)
@@ -0,0 +1,12 @@
+# Mixed int/float arithmetic: each leaf evaluates a polynomial whose
+# intermediate products and sums stay unboxed, only the final value of
+# the expression becomes a Float object.
+class Poly:
+  def Eval(x):
+    return ((((0.5 * x + 1.25) * x - 3) * x + 0.125) * x - 2.5) * x + 1
+  def Run(x, n):
+    if n > 0:
+      return self.Run(x * 1.0001, n - 1) + self.Run(x / 1.0001 - 1, n - 1)
+    return self.Eval(x) / 1e6
+poly = Poly()
+print(poly.Run(1.5, 17))
@@ -0,0 +1,19 @@
+# Report generation throughput with f-strings, which format each line into
+# one buffer. See fstring_report_concat.py for the same report built with
+# str() and concatenation.
+class Item:
+  def __init__(name, count, price):
+    self.name = name
+    self.count = count
+    self.price = price
+
+  def __str__():
+    return f"{self.name} x{self.count}"
+
+items = [Item("apple", 3, 0.5), Item("pear", 12, 1.25), Item("plum", 250, 0.1)]
+size = 0
+for i in range(100000):
+  for item in items:
+    line = f"#{i}: {item} at {item.price} = {item.count * i} total"
+    size = size + len(line)
+print(size)
@@ -0,0 +1,18 @@
+# The report of fstring_report.py built with str() and concatenation, each
+# step of which allocates an intermediate string.
+class Item:
+  def __init__(name, count, price):
+    self.name = name
+    self.count = count
+    self.price = price
+
+  def __str__():
+    return self.name + " x" + str(self.count)
+
+items = [Item("apple", 3, 0.5), Item("pear", 12, 1.25), Item("plum", 250, 0.1)]
+size = 0
+for i in range(100000):
+  for item in items:
+    line = "#" + str(i) + ": " + str(item) + " at " + str(item.price) + " = " + str(item.count * i) + " total"
+    size = size + len(line)
+print(size)
@@ -0,0 +1,8 @@
+# Recursive module-level function, its call sites are bound to the function
+# by the parser. method_recursion.py runs the same recursion through the
+# class-based workaround.
+def fib(n):
+  if n < 2:
+    return n
+  return fib(n - 1) + fib(n - 2)
+print(fib(25))
@@ -0,0 +1,21 @@
+# A lazy pipeline of generators over a large file, generated as for
+# file_lines.py. Each stage holds one line at a time, so the memory use
+# stays the same whatever the size of the file.
+class Pipeline:
+  def Lines(path):
+    for line in open(path):
+      yield line
+  def Matching(lines, prefix):
+    for line in lines:
+      if line.startswith(prefix):
+        yield line
+  def Fields(lines):
+    for line in lines:
+      yield line.split(",")
+pipeline = Pipeline()
+count = 0
+total = 0
+for fields in pipeline.Fields(pipeline.Matching(pipeline.Lines("/tmp/lines200.csv"), "2024-01-01,sensor-17")):
+  count = count + 1
+  total = total + len(fields[3])
+print(count, total)
@@ -0,0 +1,19 @@
+# Fills a list with ints and sums it back through indexing. The list keeps
+# raw ints, so appends and stores don't allocate an object per element.
+class Filler:
+  def Fill(xs, lo, n):
+    if n == 1:
+      xs.append(lo)
+      return None
+    half = n / 2
+    self.Fill(xs, lo, half)
+    self.Fill(xs, lo + half, n - half)
+  def Sum(xs, lo, n):
+    if n == 1:
+      return xs[lo]
+    half = n / 2
+    return self.Sum(xs, lo, half) + self.Sum(xs, lo + half, n - half)
+filler = Filler()
+xs = []
+filler.Fill(xs, 0, 200000)
+print(len(xs), filler.Sum(xs, 0, len(xs)))
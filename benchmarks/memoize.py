@@ -0,0 +1,12 @@
+# Counts the partitions of n into parts of at most k with the recurrence
+# P(n, k) = P(n, k - 1) + P(n - k, k). Without @memoize the calls grow
+# exponentially with n, with it each of the n * k pairs runs once.
+@memoize(65536)
+def Partitions(n, k):
+  if n == 0:
+    return 1
+  if n < 0 or k == 0:
+    return 0
+  return Partitions(n, k - 1) + Partitions(n - k, k)
+print(Partitions(200, 200))
+print(Partitions(400, 400))
@@ -0,0 +1,59 @@
+# Same as method_dispatch_deep.py, but the receiver is the root class itself.
+class Base:
+  def Value():
+    return 1
+class Level1(Base):
+  def Level1():
+    return 1
+class Level2(Level1):
+  def Level2():
+    return 2
+class Level3(Level2):
+  def Level3():
+    return 3
+class Level4(Level3):
+  def Level4():
+    return 4
+class Level5(Level4):
+  def Level5():
+    return 5
+class Level6(Level5):
+  def Level6():
+    return 6
+class Level7(Level6):
+  def Level7():
+    return 7
+class Level8(Level7):
+  def Level8():
+    return 8
+class Level9(Level8):
+  def Level9():
+    return 9
+class Level10(Level9):
+  def Level10():
+    return 10
+class Level11(Level10):
+  def Level11():
+    return 11
+class Level12(Level11):
+  def Level12():
+    return 12
+class Level13(Level12):
+  def Level13():
+    return 13
+class Level14(Level13):
+  def Level14():
+    return 14
+class Level15(Level14):
+  def Level15():
+    return 15
+class Level16(Level15):
+  def Level16():
+    return 16
+class Runner:
+  def Run(obj, n):
+    if n == 0:
+      return obj.Value()
+    return self.Run(obj, n - 1) + self.Run(obj, n - 1)
+runner = Runner()
+print(runner.Run(Base(), 16))
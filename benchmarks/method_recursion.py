@@ -0,0 +1,8 @@
+# The recursion of function_calls.py written as a method, the way helpers
+# had to be written before module-level functions.
+class Math:
+  def fib(n):
+    if n < 2:
+      return n
+    return self.fib(n - 1) + self.fib(n - 2)
+print(Math().fib(25))
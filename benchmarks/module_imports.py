@@ -0,0 +1,11 @@
+# Imports vectors directly and through polygons: it's loaded once, and the
+# Vector instances made here and in polygons are of one class. Run with
+# --stats for the load times of the modules.
+import vectors
+import polygons
+total = 0
+origin = Vector(0, 0)
+for i in range(1, 200000):
+  t = Triangle(origin, Vector(i, 0), Vector(0, 2))
+  total = total + t.area2() + Dot(t.b, t.c)
+print(total, Vector(1, 2) == Add(t.a, Vector(1, 2)))
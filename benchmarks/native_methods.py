@@ -0,0 +1,20 @@
+# Sums gcds through the native Math.gcd and through the same algorithm as a
+# method of the script. Native methods are called through the same path as
+# script methods, without a closure for their arguments. Run with --math,
+# which registers the builtin Math class.
+class Euclid:
+  def gcd(a, b):
+    while b != 0:
+      t = b
+      b = a - a / b * b
+      a = t
+    return a
+math = Math()
+euclid = Euclid()
+native = 0
+script = 0
+for i in range(1, 300000):
+  native = native + math.gcd(i, 360360)
+for i in range(1, 300000):
+  script = script + euclid.gcd(i, 360360)
+print(native, script)
@@ -0,0 +1,11 @@
+# Library module of module_imports.py, itself importing vectors. Its
+# triangles are made of the same Vector class the main script gets.
+import vectors
+class Triangle:
+  def __init__(a, b, c):
+    self.a = a
+    self.b = b
+    self.c = c
+  def area2():
+    ab = Sub(self.b, self.a)
+    return ab.cross(Sub(self.c, self.a))
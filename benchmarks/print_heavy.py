@@ -0,0 +1,7 @@
+# Print-heavy workload of 600000 lines of ints, strings and bools. Redirect
+# the output to a file or /dev/null, and compare --flush=line, which writes
+# every line out on its own, with the default block buffering.
+for i in range(200000):
+  print(i, i * 3, "name", i > 5)
+  print("row", i)
+  print(i, [i, "x"])
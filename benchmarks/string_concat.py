@@ -0,0 +1,15 @@
+# Appends to a string field 2^18 times. Each append copies the whole string
+# unless concatenation extends the buffer in place, which would make this
+# quadratic (about 100GB of copying) instead of linear.
+class Builder:
+  def __init__():
+    self.text = ""
+  def Grow(n):
+    if n == 0:
+      self.text = self.text + "abc"
+      return None
+    self.Grow(n - 1)
+    self.Grow(n - 1)
+builder = Builder()
+builder.Grow(18)
+print(builder.text == "abc" * 262144)
@@ -0,0 +1,14 @@
+# Text processing with the built-in string methods over a 1.1MB text. Run
+# with --no-simd to compare the AVX2 kernels with the SSE2 ones, and see
+# string_methods_naive.py for the same counts written as loops.
+text = "The quick brown fox jumps over the lazy dog. " * 25000
+words = 0
+foxes = 0
+found = 0
+for i in range(20):
+  words = words + text.count(" ")
+  foxes = foxes + text.count("fox")
+  found = found + text.find("cat", i)
+  upper = text.upper()
+  found = found + upper.find("LAZY DOG", 500000)
+print(words, foxes, found, len(text.replace("dog", "cat")), len(text.split(".")))
@@ -0,0 +1,20 @@
+# Parsing-style script that consumes a 230KB text from the front, slicing
+# off one record at a time and cutting the fields out of it. The slices
+# share the buffer of the text, so taking the rest of the text is O(1)
+# rather than a copy, and only the fields kept in the dict are copied.
+text = "alice,42,paris;bob,7,berlin;carol,1234,tokyo;" * 5000
+cities = {}
+total = 0
+for i in range(10):
+  rest = text
+  end = rest.find(";")
+  while end >= 0:
+    line = rest[:end]
+    first = line.find(",")
+    second = line.find(",", first + 1)
+    name = line[:first]
+    total = total + len(name) + len(line[first + 1:second])
+    cities[name] = line[second + 1:]
+    rest = rest[end + 1:]
+    end = rest.find(";")
+print(total, len(cities), cities["carol"], len(rest))
@@ -0,0 +1,13 @@
+# Multiple return values: each leaf returns a (quotient, remainder) pair
+# that the caller unpacks, which used to take a whole instance with its own
+# field map per call.
+class Splitter:
+  def DivMod(a, b):
+    return a / b, a - a / b * b
+  def Run(a, n):
+    if n > 0:
+      return self.Run(a + 7, n - 1) + self.Run(a + 3, n - 1)
+    q, r = self.DivMod(a, 10)
+    return q + r
+splitter = Splitter()
+print(splitter.Run(12345, 17))
@@ -0,0 +1,17 @@
+# Library module of module_imports.py: 2D vectors with integer coordinates.
+class Vector:
+  def __init__(x, y):
+    self.x = x
+    self.y = y
+  def cross(other):
+    return self.x * other.y - self.y * other.x
+  def __eq__(other):
+    return self.x == other.x and self.y == other.y
+  def __str__():
+    return "(" + str(self.x) + ", " + str(self.y) + ")"
+def Add(a, b):
+  return Vector(a.x + b.x, a.y + b.y)
+def Sub(a, b):
+  return Vector(a.x - b.x, a.y - b.y)
+def Dot(a, b):
+  return a.x * b.x + a.y * b.y
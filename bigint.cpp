@@ -0,0 +1,451 @@
+#include "bigint.h"
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Below this number of limbs schoolbook multiplication beats Karatsuba
+constexpr size_t KaratsubaThreshold = 32;
+
+void Trim(std::vector<uint32_t>& limbs)
+{
+    while (!limbs.empty() && limbs.back() == 0)
+        limbs.pop_back();
+}
+
+}
+
+BigInteger::BigInteger(long long value)
+{
+    m_Negative = value < 0;
+
+    // Negating LLONG_MIN overflows, so the magnitude is built from unsigned
+    unsigned long long magnitude = m_Negative ? 0ull - static_cast<unsigned long long>(value) : value;
+    while (magnitude)
+    {
+        m_Limbs.push_back(static_cast<Limb>(magnitude % Base));
+        magnitude /= Base;
+    }
+}
+
+BigInteger::BigInteger(Magnitude limbs, bool negative)
+    : m_Limbs(std::move(limbs)), m_Negative(negative)
+{
+    Trim(m_Limbs);
+    if (m_Limbs.empty())
+        m_Negative = false;
+}
+
+BigInteger BigInteger::FromString(std::string_view digits)
+{
+    bool negative = false;
+    if (!digits.empty() && (digits.front() == '-' || digits.front() == '+'))
+    {
+        negative = digits.front() == '-';
+        digits.remove_prefix(1);
+    }
+
+    if (digits.empty() || !std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; }))
+        throw std::runtime_error("Invalid integer literal " + std::string(digits));
+
+    Magnitude limbs;
+    limbs.reserve(digits.size() / DigitsPerLimb + 1);
+
+    for (size_t end = digits.size(); end > 0; )
+    {
+        size_t begin = end > DigitsPerLimb ? end - DigitsPerLimb : 0;
+        Limb limb = 0;
+        std::from_chars(digits.data() + begin, digits.data() + end, limb);
+        limbs.push_back(limb);
+        end = begin;
+    }
+
+    return BigInteger(std::move(limbs), negative);
+}
+
+std::optional<int> BigInteger::TryToInt() const
+{
+    if (m_Limbs.size() > 2)
+        return std::nullopt;
+
+    long long value = 0;
+    for (size_t i = m_Limbs.size(); i-- > 0; )
+        value = value * Base + m_Limbs[i];
+
+    if (m_Negative)
+        value = -value;
+
+    if (value < INT_MIN || value > INT_MAX)
+        return std::nullopt;
+
+    return static_cast<int>(value);
+}
+
+std::string BigInteger::ToString() const
+{
+    if (m_Limbs.empty())
+        return "0";
+
+    std::string result(m_Negative + m_Limbs.size() * DigitsPerLimb, '0');
+    char* begin = result.data();
+    char* const end = begin + result.size();
+
+    if (m_Negative)
+        *begin++ = '-';
+
+    // The most significant limb isn't padded, every other one takes exactly
+    // DigitsPerLimb digits
+    char* p = std::to_chars(begin, end, m_Limbs.back()).ptr;
+    for (size_t i = m_Limbs.size() - 1; i-- > 0; )
+    {
+        char buffer[DigitsPerLimb];
+        char* digitsEnd = std::to_chars(buffer, buffer + DigitsPerLimb, m_Limbs[i]).ptr;
+        size_t count = digitsEnd - buffer;
+        std::fill(p, p + DigitsPerLimb - count, '0');
+        std::copy(buffer, digitsEnd, p + DigitsPerLimb - count);
+        p += DigitsPerLimb;
+    }
+
+    result.resize(p - result.data());
+    return result;
+}
+
+BigInteger BigInteger::operator-() const
+{
+    return BigInteger(m_Limbs, !m_Negative);
+}
+
+int BigInteger::CompareMagnitudes(const Magnitude& lhs, const Magnitude& rhs)
+{
+    if (lhs.size() != rhs.size())
+        return lhs.size() < rhs.size() ? -1 : 1;
+
+    for (size_t i = lhs.size(); i-- > 0; )
+    {
+        if (lhs[i] != rhs[i])
+            return lhs[i] < rhs[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+BigInteger::Magnitude BigInteger::AddMagnitudes(const Magnitude& lhs, const Magnitude& rhs)
+{
+    const Magnitude& longer = lhs.size() >= rhs.size() ? lhs : rhs;
+    const Magnitude& shorter = lhs.size() >= rhs.size() ? rhs : lhs;
+
+    Magnitude result;
+    result.reserve(longer.size() + 1);
+
+    Limb carry = 0;
+    for (size_t i = 0; i < longer.size(); i++)
+    {
+        Limb sum = longer[i] + carry + (i < shorter.size() ? shorter[i] : 0);
+        carry = sum >= Base;
+        result.push_back(carry ? sum - Base : sum);
+    }
+
+    if (carry)
+        result.push_back(carry);
+
+    return result;
+}
+
+// Requires lhs >= rhs
+BigInteger::Magnitude BigInteger::SubMagnitudes(const Magnitude& lhs, const Magnitude& rhs)
+{
+    Magnitude result;
+    result.reserve(lhs.size());
+
+    int64_t borrow = 0;
+    for (size_t i = 0; i < lhs.size(); i++)
+    {
+        int64_t diff = static_cast<int64_t>(lhs[i]) - borrow - (i < rhs.size() ? rhs[i] : 0);
+        borrow = diff < 0;
+        result.push_back(static_cast<Limb>(borrow ? diff + Base : diff));
+    }
+
+    Trim(result);
+    return result;
+}
+
+BigInteger::Magnitude BigInteger::MulMagnitudes(const Magnitude& lhs, const Magnitude& rhs)
+{
+    if (lhs.empty() || rhs.empty())
+        return {};
+
+    if (std::min(lhs.size(), rhs.size()) < KaratsubaThreshold)
+    {
+        Magnitude result(lhs.size() + rhs.size(), 0);
+        for (size_t i = 0; i < lhs.size(); i++)
+        {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < rhs.size(); j++)
+            {
+                uint64_t current = result[i + j] + static_cast<uint64_t>(lhs[i]) * rhs[j] + carry;
+                result[i + j] = static_cast<Limb>(current % Base);
+                carry = current / Base;
+            }
+            for (size_t k = i + rhs.size(); carry; k++)
+            {
+                uint64_t current = result[k] + carry;
+                result[k] = static_cast<Limb>(current % Base);
+                carry = current / Base;
+            }
+        }
+        Trim(result);
+        return result;
+    }
+
+    const Magnitude& longer = lhs.size() >= rhs.size() ? lhs : rhs;
+    const Magnitude& shorter = lhs.size() >= rhs.size() ? rhs : lhs;
+
+    Magnitude result(lhs.size() + rhs.size() + 1, 0);
+
+    if (2 * shorter.size() <= longer.size())
+    {
+        // Unbalanced operands are multiplied in balanced slices of the longer one
+        for (size_t offset = 0; offset < longer.size(); offset += shorter.size())
+        {
+            size_t end = std::min(offset + shorter.size(), longer.size());
+            Magnitude slice(longer.begin() + offset, longer.begin() + end);
+            Trim(slice);
+            AddShifted(result, MulMagnitudes(slice, shorter), offset);
+        }
+
+        Trim(result);
+        return result;
+    }
+
+    // Karatsuba: with x = x1 * B^m + x0 the product is
+    // z2 * B^2m + ((x0 + x1)(y0 + y1) - z2 - z0) * B^m + z0
+    size_t half = longer.size() / 2;
+
+    auto split = [half](const Magnitude& value) {
+        Magnitude low(value.begin(), value.begin() + half);
+        Magnitude high(value.begin() + half, value.end());
+        Trim(low);
+        return std::make_pair(std::move(low), std::move(high));
+    };
+
+    auto [lhsLow, lhsHigh] = split(lhs);
+    auto [rhsLow, rhsHigh] = split(rhs);
+
+    Magnitude low = MulMagnitudes(lhsLow, rhsLow);
+    Magnitude high = MulMagnitudes(lhsHigh, rhsHigh);
+    Magnitude middle = MulMagnitudes(AddMagnitudes(lhsLow, lhsHigh), AddMagnitudes(rhsLow, rhsHigh));
+    middle = SubMagnitudes(SubMagnitudes(middle, low), high);
+
+    AddShifted(result, low, 0);
+    AddShifted(result, middle, half);
+    AddShifted(result, high, 2 * half);
+
+    Trim(result);
+    return result;
+}
+
+void BigInteger::AddShifted(Magnitude& result, const Magnitude& value, size_t shift)
+{
+    Limb carry = 0;
+    for (size_t i = 0; i < value.size() || carry; i++)
+    {
+        Limb sum = result[i + shift] + carry + (i < value.size() ? value[i] : 0);
+        carry = sum >= Base;
+        result[i + shift] = carry ? sum - Base : sum;
+    }
+}
+
+// Knuth's algorithm D, see TAOCP vol. 2, 4.3.1
+void BigInteger::DivModMagnitudes(const Magnitude& lhs, const Magnitude& rhs, Magnitude& quotient, Magnitude& remainder)
+{
+    if (CompareMagnitudes(lhs, rhs) < 0)
+    {
+        quotient.clear();
+        remainder = lhs;
+        return;
+    }
+
+    if (rhs.size() == 1)
+    {
+        quotient.assign(lhs.size(), 0);
+        uint64_t rest = 0;
+        for (size_t i = lhs.size(); i-- > 0; )
+        {
+            uint64_t current = rest * Base + lhs[i];
+            quotient[i] = static_cast<Limb>(current / rhs[0]);
+            rest = current % rhs[0];
+        }
+        Trim(quotient);
+        remainder.clear();
+        if (rest)
+            remainder.push_back(static_cast<Limb>(rest));
+        return;
+    }
+
+    // Scale both operands so that the top limb of the divisor is at least
+    // Base / 2, which keeps the estimated quotient digits off by at most 2
+    const Limb scale = Base / (rhs.back() + 1);
+    auto multiply = [scale](const Magnitude& value) {
+        Magnitude result;
+        result.reserve(value.size() + 1);
+        uint64_t carry = 0;
+        for (Limb limb : value)
+        {
+            uint64_t current = static_cast<uint64_t>(limb) * scale + carry;
+            result.push_back(static_cast<Limb>(current % Base));
+            carry = current / Base;
+        }
+        result.push_back(static_cast<Limb>(carry));
+        return result;
+    };
+
+    Magnitude u = multiply(lhs);
+    Magnitude v = multiply(rhs);
+    Trim(v);
+
+    const size_t n = v.size();
+    const size_t m = u.size() - n;
+    quotient.assign(m, 0);
+
+    for (size_t j = m; j-- > 0; )
+    {
+        uint64_t numerator = static_cast<uint64_t>(u[j + n]) * Base + u[j + n - 1];
+        uint64_t qhat = numerator / v[n - 1];
+        uint64_t rhat = numerator % v[n - 1];
+
+        while (qhat >= Base || qhat * v[n - 2] > rhat * Base + u[j + n - 2])
+        {
+            qhat--;
+            rhat += v[n - 1];
+            if (rhat >= Base)
+                break;
+        }
+
+        int64_t borrow = 0;
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t product = qhat * v[i] + carry;
+            carry = product / Base;
+            int64_t diff = static_cast<int64_t>(u[i + j]) - static_cast<int64_t>(product % Base) - borrow;
+            borrow = diff < 0;
+            u[i + j] = static_cast<Limb>(borrow ? diff + Base : diff);
+        }
+
+        int64_t top = static_cast<int64_t>(u[j + n]) - static_cast<int64_t>(carry) - borrow;
+        if (top < 0)
+        {
+            // The estimate was one too big, add the divisor back
+            qhat--;
+            u[j + n] = static_cast<Limb>(top + Base);
+            Limb addCarry = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                Limb sum = u[i + j] + v[i] + addCarry;
+                addCarry = sum >= Base;
+                u[i + j] = addCarry ? sum - Base : sum;
+            }
+            u[j + n] = (u[j + n] + addCarry) % Base;
+        }
+        else
+        {
+            u[j + n] = static_cast<Limb>(top);
+        }
+
+        quotient[j] = static_cast<Limb>(qhat);
+    }
+
+    Trim(quotient);
+
+    u.resize(n);
+    Trim(u);
+    remainder.assign(u.size(), 0);
+    uint64_t rest = 0;
+    for (size_t i = u.size(); i-- > 0; )
+    {
+        uint64_t current = rest * Base + u[i];
+        remainder[i] = static_cast<Limb>(current / scale);
+        rest = current % scale;
+    }
+    Trim(remainder);
+}
+
+BigInteger BigInteger::AddSigned(const BigInteger& lhs, const BigInteger& rhs, bool negateRhs)
+{
+    bool rhsNegative = rhs.m_Negative != negateRhs;
+
+    if (lhs.m_Negative == rhsNegative)
+        return BigInteger(AddMagnitudes(lhs.m_Limbs, rhs.m_Limbs), lhs.m_Negative);
+
+    if (CompareMagnitudes(lhs.m_Limbs, rhs.m_Limbs) >= 0)
+        return BigInteger(SubMagnitudes(lhs.m_Limbs, rhs.m_Limbs), lhs.m_Negative);
+    else
+        return BigInteger(SubMagnitudes(rhs.m_Limbs, lhs.m_Limbs), rhsNegative);
+}
+
+BigInteger operator+(const BigInteger& lhs, const BigInteger& rhs)
+{
+    return BigInteger::AddSigned(lhs, rhs, false);
+}
+
+BigInteger operator-(const BigInteger& lhs, const BigInteger& rhs)
+{
+    return BigInteger::AddSigned(lhs, rhs, true);
+}
+
+BigInteger operator*(const BigInteger& lhs, const BigInteger& rhs)
+{
+    return BigInteger(BigInteger::MulMagnitudes(lhs.m_Limbs, rhs.m_Limbs), lhs.m_Negative != rhs.m_Negative);
+}
+
+BigInteger operator/(const BigInteger& lhs, const BigInteger& rhs)
+{
+    if (rhs.IsZero())
+        throw std::runtime_error("Division by zero");
+
+    BigInteger::Magnitude quotient, remainder;
+    BigInteger::DivModMagnitudes(lhs.m_Limbs, rhs.m_Limbs, quotient, remainder);
+    return BigInteger(std::move(quotient), lhs.m_Negative != rhs.m_Negative);
+}
+
+BigInteger operator%(const BigInteger& lhs, const BigInteger& rhs)
+{
+    if (rhs.IsZero())
+        throw std::runtime_error("Division by zero");
+
+    BigInteger::Magnitude quotient, remainder;
+    BigInteger::DivModMagnitudes(lhs.m_Limbs, rhs.m_Limbs, quotient, remainder);
+    return BigInteger(std::move(remainder), lhs.m_Negative);
+}
+
+std::strong_ordering operator<=>(const BigInteger& lhs, const BigInteger& rhs)
+{
+    if (lhs.m_Negative != rhs.m_Negative)
+        return lhs.m_Negative ? std::strong_ordering::less : std::strong_ordering::greater;
+
+    int result = BigInteger::CompareMagnitudes(lhs.m_Limbs, rhs.m_Limbs);
+    if (lhs.m_Negative)
+        result = -result;
+
+    return result <=> 0;
+}
+
+double BigInteger::ToDouble() const
+{
+    // Accumulating limbs would round at every step, parsing the decimal
+    // digits rounds once
+    std::string digits = ToString();
+    double result = 0;
+    std::from_chars_result parsed = std::from_chars(digits.data(), digits.data() + digits.size(), result);
+
+    if (parsed.ec == std::errc::result_out_of_range)
+        return m_Negative ? -HUGE_VAL : HUGE_VAL;
+    return result;
+}
+
+std::ostream& operator<<(std::ostream& os, const BigInteger& value)
+{
+    return os << value.ToString();
+}
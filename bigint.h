@@ -0,0 +1,70 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Arbitrary-precision signed integer. The magnitude is stored in base 10^9
+// limbs, least significant first, so conversions from and to decimal are
+// linear. Division truncates towards zero like the built-in int division.
+class BigInteger
+{
+public:
+    BigInteger() = default;
+    BigInteger(long long value);
+
+    static BigInteger FromString(std::string_view digits);
+
+    bool IsZero() const
+    {
+        return m_Limbs.empty();
+    }
+
+    bool IsNegative() const
+    {
+        return m_Negative;
+    }
+
+    std::optional<int> TryToInt() const;
+    std::string ToString() const;
+    // Nearest double, or an infinity when the value is out of its range
+    double ToDouble() const;
+
+    BigInteger operator-() const;
+
+    friend BigInteger operator+(const BigInteger& lhs, const BigInteger& rhs);
+    friend BigInteger operator-(const BigInteger& lhs, const BigInteger& rhs);
+    friend BigInteger operator*(const BigInteger& lhs, const BigInteger& rhs);
+    friend BigInteger operator/(const BigInteger& lhs, const BigInteger& rhs);
+    friend BigInteger operator%(const BigInteger& lhs, const BigInteger& rhs);
+
+    friend std::strong_ordering operator<=>(const BigInteger& lhs, const BigInteger& rhs);
+    friend bool operator==(const BigInteger& lhs, const BigInteger& rhs) = default;
+
+private:
+    using Limb = uint32_t;
+    using Magnitude = std::vector<Limb>;
+
+    static constexpr Limb Base = 1'000'000'000;
+    static constexpr size_t DigitsPerLimb = 9;
+
+    BigInteger(Magnitude limbs, bool negative);
+
+    static int CompareMagnitudes(const Magnitude& lhs, const Magnitude& rhs);
+    static Magnitude AddMagnitudes(const Magnitude& lhs, const Magnitude& rhs);
+    static Magnitude SubMagnitudes(const Magnitude& lhs, const Magnitude& rhs);
+    static Magnitude MulMagnitudes(const Magnitude& lhs, const Magnitude& rhs);
+    static void AddShifted(Magnitude& result, const Magnitude& value, size_t shift);
+    static void DivModMagnitudes(const Magnitude& lhs, const Magnitude& rhs, Magnitude& quotient, Magnitude& remainder);
+
+    static BigInteger AddSigned(const BigInteger& lhs, const BigInteger& rhs, bool negateRhs);
+
+    Magnitude m_Limbs;
+    bool m_Negative = false;
+};
+
+std::ostream& operator<<(std::ostream& os, const BigInteger& value);
@@ -0,0 +1,150 @@
+#include "collector.h"
+#include "object.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <vector>
+
+namespace Runtime {
+
+Collectable::Collectable()
+{
+    Collector::Get().Track(this);
+}
+
+Collectable::~Collectable()
+{
+    Collector::Get().Untrack(this);
+}
+
+Collector& Collector::Get()
+{
+    // Never destroyed, objects may outlive static destructors
+    static Collector* collector = new Collector();
+    return *collector;
+}
+
+void Collector::Track(Collectable* object)
+{
+    object->m_Next = m_Head;
+    if (m_Head)
+        m_Head->m_Prev = object;
+    m_Head = object;
+
+    m_Allocations++;
+    m_Statistics.tracked++;
+}
+
+void Collector::Untrack(Collectable* object)
+{
+    if (object->m_Prev)
+        object->m_Prev->m_Next = object->m_Next;
+    else
+        m_Head = object->m_Next;
+
+    if (object->m_Next)
+        object->m_Next->m_Prev = object->m_Prev;
+
+    m_Statistics.tracked--;
+}
+
+static Collectable* AsOwnedCollectable(const ObjectHolder& object)
+{
+    if (!object || !object.IsOwning())
+        return nullptr;
+
+    return dynamic_cast<Collectable*>(const_cast<Object*>(object.Get()));
+}
+
+size_t Collector::Collect()
+{
+    if (m_Collecting)
+        return 0;
+
+    m_Collecting = true;
+    auto start = std::chrono::steady_clock::now();
+
+    // Objects that aren't owned by a shared pointer are being constructed
+    // or live outside of the heap, so they are treated as reachable
+    static constexpr long Reachable = LONG_MAX;
+
+    for (Collectable* object = m_Head; object; object = object->m_Next)
+    {
+        long useCount = object->weak_from_this().use_count();
+        object->m_GcRefs = useCount > 0 ? useCount : Reachable;
+    }
+
+    for (Collectable* object = m_Head; object; object = object->m_Next)
+    {
+        object->Traverse([](const ObjectHolder& ref) {
+            if (Collectable* target = AsOwnedCollectable(ref); target && target->m_GcRefs != Reachable)
+                target->m_GcRefs--;
+        });
+    }
+
+    std::vector<Collectable*> pending;
+    for (Collectable* object = m_Head; object; object = object->m_Next)
+    {
+        if (object->m_GcRefs > 0)
+        {
+            object->m_GcRefs = Reachable;
+            pending.push_back(object);
+        }
+    }
+
+    while (!pending.empty())
+    {
+        Collectable* object = pending.back();
+        pending.pop_back();
+
+        object->Traverse([&pending](const ObjectHolder& ref) {
+            if (Collectable* target = AsOwnedCollectable(ref); target && target->m_GcRefs != Reachable)
+            {
+                target->m_GcRefs = Reachable;
+                pending.push_back(target);
+            }
+        });
+    }
+
+    // Keep the garbage alive until all of it is cleared, so that clearing
+    // one object doesn't destroy another one the loop is about to visit
+    std::vector<std::shared_ptr<Collectable>> garbage;
+    for (Collectable* object = m_Head; object; object = object->m_Next)
+    {
+        if (object->m_GcRefs != Reachable)
+            garbage.push_back(object->shared_from_this());
+    }
+
+    for (const auto& object : garbage)
+    {
+        object->Clear();
+    }
+
+    size_t collected = garbage.size();
+    garbage.clear();
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    m_Statistics.collections++;
+    m_Statistics.collected += collected;
+    m_Statistics.totalTimeMs += elapsed.count();
+    m_Statistics.maxTimeMs = std::max(m_Statistics.maxTimeMs, elapsed.count());
+
+    size_t survivors = m_Statistics.tracked;
+    m_Allocations = 0;
+    m_NextCollection = std::max(m_Threshold, static_cast<size_t>(survivors * m_SurvivorRatio));
+    m_Collecting = false;
+    return collected;
+}
+
+void PrintCollectorStatistics(std::ostream& os)
+{
+    const CollectorStatistics& stats = Collector::Get().GetStatistics();
+    os << "Collector" << '\n'
+       << "tracked " << stats.tracked << ", "
+       << "collections " << stats.collections << ", "
+       << "collected " << stats.collected << ", "
+       << "total " << stats.totalTimeMs << "ms, "
+       << "max pause " << stats.maxTimeMs << "ms" << '\n';
+}
+
+}
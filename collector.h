@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include "object_holder.h"
+
+namespace Runtime {
+
+class Object;
+
+// Objects that hold references to other objects and so may be part of a
+// reference cycle. All of them are tracked by the collector.
+class Collectable : public std::enable_shared_from_this<Collectable>
+{
+public:
+    using Visitor = std::function<void(const ObjectHolder&)>;
+
+    Collectable();
+    Collectable(const Collectable&) = delete;
+    Collectable& operator=(const Collectable&) = delete;
+    virtual ~Collectable();
+
+    // Visits every reference the object holds
+    virtual void Traverse(const Visitor& visit) const = 0;
+    // Drops every reference the object holds
+    virtual void Clear() = 0;
+
+private:
+    friend class Collector;
+
+    Collectable* m_Prev = nullptr;
+    Collectable* m_Next = nullptr;
+    long m_GcRefs = 0;
+};
+
+struct CollectorStatistics
+{
+    size_t tracked = 0;
+    size_t collections = 0;
+    size_t collected = 0;
+    double totalTimeMs = 0;
+    double maxTimeMs = 0;
+};
+
+// Trial deletion cycle collector. The references between tracked objects
+// are subtracted from their reference counts, the objects left with
+// references are reachable from the outside and so is everything they
+// reach. The rest is only kept alive by cycles and gets cleared.
+class Collector
+{
+public:
+    static Collector& Get();
+
+    // Collects once the number of objects allocated since the last
+    // collection exceeds the threshold, or the number of survivors of the
+    // last collection times the ratio if that's bigger. A zero threshold
+    // disables automatic collections.
+    void SetThreshold(size_t threshold)
+    {
+        m_Threshold = threshold;
+        m_NextCollection = threshold;
+    }
+
+    void SetSurvivorRatio(double ratio)
+    {
+        m_SurvivorRatio = ratio;
+    }
+
+    void MaybeCollect()
+    {
+        if (m_Threshold > 0 && m_Allocations >= m_NextCollection)
+            Collect();
+    }
+
+    size_t Collect();
+
+    const CollectorStatistics& GetStatistics() const
+    {
+        return m_Statistics;
+    }
+
+private:
+    friend class Collectable;
+
+    Collector() = default;
+
+    void Track(Collectable* object);
+    void Untrack(Collectable* object);
+
+    Collectable* m_Head = nullptr;
+    size_t m_Threshold = 10000;
+    double m_SurvivorRatio = 1.0;
+    size_t m_Allocations = 0;
+    size_t m_NextCollection = 10000;
+    bool m_Collecting = false;
+    CollectorStatistics m_Statistics;
+};
+
+void PrintCollectorStatistics(std::ostream& os);
+
+}
@@ -1,69 +1,294 @@
 #include "comparators.h"
 #include "object.h"
 
-#include <functional>
+#include <cmath>
+#include <compare>
+#include <limits>
 #include <optional>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 
 namespace Runtime {
 
-template <typename T, typename Cmp>
-std::optional<bool> TryCompare(const ObjectHolder& lhs, const ObjectHolder& rhs, Cmp cmp)
+namespace {
+
+template <typename T>
+const T& As(const ObjectHolder& object)
 {
-    const T* left = lhs.TryAs<T>();
-    const T* right = rhs.TryAs<T>();
+    return static_cast<const T&>(*object);
+}
 
-    if (left && right)
+BigInteger ToBigInteger(const ObjectHolder& object, TypeTag tag)
+{
+    switch (tag)
     {
-        return cmp(left->GetValue(), right->GetValue());
+    case TypeTag::Number:
+        return As<Number>(object).GetValue();
+    case TypeTag::Bool:
+        return As<Bool>(object).GetValue() ? 1 : 0;
+    default:
+        return As<BigInt>(object).GetValue();
     }
-    else
+}
+
+// Bools are the integers 0 and 1 next to other numbers, like in Python
+bool IsInteger(TypeTag tag)
+{
+    return tag == TypeTag::Number || tag == TypeTag::BigInt || tag == TypeTag::Bool;
+}
+
+bool IsReal(TypeTag tag)
+{
+    return IsInteger(tag) || tag == TypeTag::Float;
+}
+
+double ToDouble(const ObjectHolder& object, TypeTag tag)
+{
+    switch (tag)
+    {
+    case TypeTag::Number:
+        return As<Number>(object).GetValue();
+    case TypeTag::BigInt:
+        return As<BigInt>(object).GetValue().ToDouble();
+    case TypeTag::Bool:
+        return As<Bool>(object).GetValue() ? 1 : 0;
+    default:
+        return As<Float>(object).GetValue();
+    }
+}
+
+// Ordering of two builtin values, or nullopt when their types don't compare.
+// Floats make it partial, NaN is unordered with everything.
+std::optional<std::partial_ordering> OrderBuiltins(const ObjectHolder& lhs, const ObjectHolder& rhs)
+{
+    TypeTag left = GetTypeTag(lhs);
+    TypeTag right = GetTypeTag(rhs);
+
+    if (left == TypeTag::Number && right == TypeTag::Number)
+        return As<Number>(lhs).GetValue() <=> As<Number>(rhs).GetValue();
+
+    if (left == TypeTag::Bool && right == TypeTag::Bool)
+        return As<Bool>(lhs).GetValue() <=> As<Bool>(rhs).GetValue();
+
+    if (IsInteger(left) && IsInteger(right))
+        return ToBigInteger(lhs, left) <=> ToBigInteger(rhs, right);
+
+    if (IsReal(left) && IsReal(right))
+        return ToDouble(lhs, left) <=> ToDouble(rhs, right);
+
+    if (left == TypeTag::String && right == TypeTag::String)
+        return As<String>(lhs).GetValue() <=> As<String>(rhs).GetValue();
+
+    return std::nullopt;
+}
+
+}
+
+std::optional<bool> EqualNumbers(const ObjectHolder& lhs, const ObjectHolder& rhs)
+{
+    if (!IsReal(GetTypeTag(lhs)) || !IsReal(GetTypeTag(rhs)))
+        return std::nullopt;
+    return *OrderBuiltins(lhs, rhs) == 0;
+}
+
+std::optional<int> ToExactInt(const ObjectHolder& value)
+{
+    switch (GetTypeTag(value))
     {
+    case TypeTag::Number:
+        return As<Number>(value).GetValue();
+    case TypeTag::Bool:
+        return As<Bool>(value).GetValue() ? 1 : 0;
+    case TypeTag::BigInt:
+        return As<BigInt>(value).GetValue().TryToInt();
+    case TypeTag::Float:
+    {
+        double number = As<Float>(value).GetValue();
+        if (number >= std::numeric_limits<int>::min() && number <= std::numeric_limits<int>::max() && number == std::trunc(number))
+            return static_cast<int>(number);
+        return std::nullopt;
+    }
+    default:
         return std::nullopt;
     }
 }
 
-bool Less(ObjectHolder lhs, ObjectHolder rhs)
+bool Satisfies(std::partial_ordering order, CompareOp op)
+{
+    switch (op)
+    {
+    case CompareOp::Less:
+        return order < 0;
+    case CompareOp::LessOrEqual:
+        return order <= 0;
+    case CompareOp::Greater:
+        return order > 0;
+    case CompareOp::GreaterOrEqual:
+        return order >= 0;
+    case CompareOp::Equal:
+        return order == 0;
+    case CompareOp::NotEqual:
+        return order != 0;
+    }
+    return false;
+}
+
+namespace {
+
+bool IsEquality(CompareOp op)
+{
+    return op == CompareOp::Equal || op == CompareOp::NotEqual;
+}
+
+ClassInstance* AsInstance(ObjectHolder& object)
+{
+    if (GetTypeTag(object) != TypeTag::Instance)
+        return nullptr;
+    return &static_cast<ClassInstance&>(*object);
+}
+
+const Method* FindMethod(const ClassInstance* instance, const std::string& name)
+{
+    if (!instance)
+        return nullptr;
+
+    const Method* method = instance->GetClass().GetMethod(name);
+    return method && method->formalParams.size() == 1 ? method : nullptr;
+}
+
+// Comparisons are inside of expressions, so a raise of the method is thrown
+ObjectHolder CallOperator(ClassInstance& instance, const Method& method, const ObjectHolder& other, Context& context)
+{
+    ObjectHolder result = instance.Call(method, std::span(&other, 1), context);
+    if (context.GetCompletion() == Completion::Raise)
+        throw Raised(context.TakeException());
+    return result;
+}
+
+// __cmp__ returns a negative, zero or positive integer like C's strcmp
+std::strong_ordering CallCmp(ClassInstance& instance, const Method& method, const ObjectHolder& other, Context& context)
+{
+    ObjectHolder result = CallOperator(instance, method, other, context);
+
+    switch (GetTypeTag(result))
+    {
+    case TypeTag::Number:
+        return As<Number>(result).GetValue() <=> 0;
+    case TypeTag::BigInt:
+        return As<BigInt>(result).GetValue() <=> BigInteger(0);
+    default:
+        throw std::runtime_error("__cmp__ must return an integer");
+    }
+}
+
+bool CallPredicate(ClassInstance& instance, const Method& method, const ObjectHolder& other, Context& context)
+{
+    return IsTrue(CallOperator(instance, method, other, context));
+}
+
+// Falls back to __lt__ and __eq__. Greater and LessOrEqual are answered by
+// the reflected rhs.__lt__(lhs) where possible, so that each operator costs
+// one call; only comparisons with a non-instance rhs need both methods.
+bool CompareInstances(ClassInstance* left, ObjectHolder& lhs, ObjectHolder& rhs, CompareOp op, Context& context)
 {
-    std::optional<bool> result = TryCompare<Runtime::Bool>(lhs, rhs, std::less<bool>());
+    if (IsEquality(op))
+    {
+        const Method* eq = FindMethod(left, "__eq__");
+        if (!eq)
+            throw std::runtime_error("Cannot compare objets for equalty");
 
-    if (!result)
-        result = TryCompare<Runtime::Number>(lhs, rhs, std::less<int>());
+        return CallPredicate(*left, *eq, rhs, context) == (op == CompareOp::Equal);
+    }
 
-    if (!result)
-        result = TryCompare<Runtime::String>(lhs, rhs, std::less<std::string>());
+    if (op == CompareOp::Greater || op == CompareOp::LessOrEqual)
+    {
+        ClassInstance* right = AsInstance(rhs);
+        if (const Method* lt = FindMethod(right, "__lt__"))
+            return CallPredicate(*right, *lt, lhs, context) == (op == CompareOp::Greater);
+    }
 
-    if (result)
-        return *result;
+    const Method* lt = FindMethod(left, "__lt__");
+    if (!lt)
+        throw std::runtime_error("Cannot compare objets for less");
 
-    if (auto p = lhs.TryAs<Runtime::ClassInstance>(); p && p->HasMethod("__lt__", 1))
+    bool less = CallPredicate(*left, *lt, rhs, context);
+    switch (op)
     {
-        return IsTrue(p->Call("__lt__", {rhs}));
+    case CompareOp::Less:
+        return less;
+    case CompareOp::GreaterOrEqual:
+        return !less;
+    default:
+        break;
     }
 
-    throw std::runtime_error("Cannot compare objets for less");
+    if (less)
+        return op == CompareOp::LessOrEqual;
+
+    const Method* eq = FindMethod(left, "__eq__");
+    if (!eq)
+        throw std::runtime_error("Cannot compare objets for equalty");
+
+    bool equal = CallPredicate(*left, *eq, rhs, context);
+    return op == CompareOp::Greater ? !equal : equal;
 }
 
-bool Equal(ObjectHolder lhs, ObjectHolder rhs)
+// Lexicographic, like Python: the first pair of elements that differ
+// decides, and a tuple that is a prefix of the other is the smaller one
+bool CompareTuples(const Tuple& lhs, const Tuple& rhs, CompareOp op, Context& context)
 {
-    std::optional<bool> result = TryCompare<Runtime::Bool>(lhs, rhs, std::equal_to<bool>());
+    if (IsEquality(op) && lhs.Size() != rhs.Size())
+        return op == CompareOp::NotEqual;
 
-    if (!result)
-        result = TryCompare<Runtime::Number>(lhs, rhs, std::equal_to<int>());
+    std::span<const ObjectHolder> left = lhs.GetItems();
+    std::span<const ObjectHolder> right = rhs.GetItems();
 
-    if (!result)
-        result = TryCompare<Runtime::String>(lhs, rhs, std::equal_to<std::string>());
+    for (size_t i = 0; i < left.size() && i < right.size(); i++)
+    {
+        if (!Compare(left[i], right[i], CompareOp::Equal, context))
+        {
+            return IsEquality(op) ? op == CompareOp::NotEqual : Compare(left[i], right[i], op, context);
+        }
+    }
+    return Satisfies(left.size() <=> right.size(), op);
+}
 
-    if (result)
-        return *result;
+}
 
-    if (auto p = lhs.TryAs<Runtime::ClassInstance>(); p && p->HasMethod("__eq__", 1))
-        return IsTrue(p->Call("__eq__", {rhs}));
+bool Compare(const ObjectHolder& lhs, const ObjectHolder& rhs, CompareOp op, Context& context)
+{
+    if (std::optional<std::partial_ordering> order = OrderBuiltins(lhs, rhs))
+        return Satisfies(*order, op);
+
+    if (GetTypeTag(lhs) == TypeTag::Instance)
+    {
+        // The methods may drop the last other reference to the operands
+        ObjectHolder self = lhs;
+        ObjectHolder other = rhs;
+        ClassInstance* left = AsInstance(self);
+
+        if (const Method* cmp = FindMethod(left, "__cmp__"))
+            return Satisfies(CallCmp(*left, *cmp, other, context), op);
+
+        return CompareInstances(left, self, other, op, context);
+    }
 
-    if (!lhs && !rhs)
-        return true;
+    if (GetTypeTag(lhs) == TypeTag::Tuple && GetTypeTag(rhs) == TypeTag::Tuple)
+    {
+        // User methods may drop the last other reference to the tuples
+        ObjectHolder left = lhs;
+        ObjectHolder right = rhs;
+        return CompareTuples(As<Tuple>(left), As<Tuple>(right), op, context);
+    }
 
-    throw std::runtime_error("Cannot compare objets for equalty");
+    if (!lhs && !rhs && IsEquality(op))
+        return op == CompareOp::Equal;
+
+    if (IsEquality(op))
+        throw std::runtime_error("Cannot compare objets for equalty");
+    throw std::runtime_error("Cannot compare objets for less");
 }
 
 }
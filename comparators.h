@@ -1,30 +1,67 @@
 #pragma once
 
 #include "object_holder.h"
+#include "context.h"
+
+#include <compare>
+#include <optional>
 
 namespace Runtime {
 
-bool Less(ObjectHolder lhs, ObjectHolder rhs);
-bool Equal(ObjectHolder lhs, ObjectHolder rhs);
+enum class CompareOp
+{
+    Less,
+    LessOrEqual,
+    Greater,
+    GreaterOrEqual,
+    Equal,
+    NotEqual,
+};
+
+// Resolves any comparison in one pass: builtins are ordered with a single
+// dispatch on their type tags and user classes with at most one method call,
+// either __cmp__ or one of __lt__ and __eq__.
+bool Compare(const ObjectHolder& lhs, const ObjectHolder& rhs, CompareOp op, Context& context);
+
+// Whether an ordering of the operands satisfies the comparison
+bool Satisfies(std::partial_ordering order, CompareOp op);
+
+// Whether two numbers of any of the numeric types are equal by value, as
+// == has them. Nothing when one of the operands isn't a number.
+std::optional<bool> EqualNumbers(const ObjectHolder& lhs, const ObjectHolder& rhs);
+
+// The int equal to a number, like 1 for 1.0 and True, nothing when the
+// value isn't a number or no int equals it
+std::optional<int> ToExactInt(const ObjectHolder& value);
+
+inline bool Less(ObjectHolder lhs, ObjectHolder rhs, Context& context)
+{
+    return Compare(lhs, rhs, CompareOp::Less, context);
+}
+
+inline bool Equal(ObjectHolder lhs, ObjectHolder rhs, Context& context)
+{
+    return Compare(lhs, rhs, CompareOp::Equal, context);
+}
 
-inline bool NotEqual(ObjectHolder lhs, ObjectHolder rhs)
+inline bool NotEqual(ObjectHolder lhs, ObjectHolder rhs, Context& context)
 {
-    return !Equal(lhs, rhs);
+    return Compare(lhs, rhs, CompareOp::NotEqual, context);
 }
 
-inline bool Greater(ObjectHolder lhs, ObjectHolder rhs)
+inline bool Greater(ObjectHolder lhs, ObjectHolder rhs, Context& context)
 {
-    return !Less(lhs, rhs) && !Equal(lhs, rhs);
+    return Compare(lhs, rhs, CompareOp::Greater, context);
 }
 
-inline bool GreaterOrEqual(ObjectHolder lhs, ObjectHolder rhs)
+inline bool GreaterOrEqual(ObjectHolder lhs, ObjectHolder rhs, Context& context)
 {
-    return !Less(lhs, rhs);
+    return Compare(lhs, rhs, CompareOp::GreaterOrEqual, context);
 }
 
-inline bool LessOrEqual(ObjectHolder lhs, ObjectHolder rhs)
+inline bool LessOrEqual(ObjectHolder lhs, ObjectHolder rhs, Context& context)
 {
-    return !Greater(lhs, rhs);
+    return Compare(lhs, rhs, CompareOp::LessOrEqual, context);
 }
 
 }
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <exception>
+#include "object_holder.h"
+
+namespace Runtime {
+
+// How the last evaluated statement completed. Anything but Normal makes
+// the enclosing statements stop and leave the signal in the context until
+// a node that handles it is reached, e.g. a method call for Return, a
+// loop for Break and Continue, and a try statement for Raise.
+enum class Completion
+{
+    Normal,
+    Return,
+    Break,
+    Continue,
+    Raise,
+};
+
+// A raise that has to leave an expression halfway, e.g. from a method
+// called in an argument of another call. It travels as a C++ exception up
+// to the next try statement, where it's handled like a raise left in the
+// context. Statements check the context, so raises that reach them are
+// never thrown.
+class Raised : public std::exception
+{
+public:
+    explicit Raised(ObjectHolder exception)
+        : m_Exception(std::move(exception))
+    {
+    }
+
+    const ObjectHolder& GetException() const
+    {
+        return m_Exception;
+    }
+
+    const char* what() const noexcept override
+    {
+        return "Uncaught exception";
+    }
+private:
+    ObjectHolder m_Exception;
+};
+
+class Context
+{
+public:
+    Completion GetCompletion() const
+    {
+        return m_Completion;
+    }
+
+    bool IsInterrupted() const
+    {
+        return m_Completion != Completion::Normal;
+    }
+
+    void SetReturn(ObjectHolder value)
+    {
+        m_Completion = Completion::Return;
+        m_ReturnValue = std::move(value);
+    }
+
+    void SetBreak()
+    {
+        m_Completion = Completion::Break;
+    }
+
+    void SetContinue()
+    {
+        m_Completion = Completion::Continue;
+    }
+
+    void SetRaise(ObjectHolder exception)
+    {
+        m_Completion = Completion::Raise;
+        m_Exception = std::move(exception);
+    }
+
+    // Called by loops once they have handled Break or Continue
+    void ResumeNormal()
+    {
+        m_Completion = Completion::Normal;
+    }
+
+    ObjectHolder TakeReturnValue()
+    {
+        m_Completion = Completion::Normal;
+        return std::move(m_ReturnValue);
+    }
+
+    // Called by try statements once they have caught a raise
+    ObjectHolder TakeException()
+    {
+        m_Completion = Completion::Normal;
+        return std::move(m_Exception);
+    }
+
+private:
+    Completion m_Completion = Completion::Normal;
+    ObjectHolder m_ReturnValue;
+    ObjectHolder m_Exception;
+};
+
+}
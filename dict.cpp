@@ -0,0 +1,321 @@
+#include "dict.h"
+#include "comparators.h"
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace Runtime {
+
+namespace {
+
+// Spreads the entropy of identity-like hashes, such as the ones of small
+// ints, over all the bits, as both the group and the tag come from them
+size_t Mix(size_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// Bit i is set when byte i of the group equals the value
+uint32_t MatchByte(const int8_t* group, int8_t value)
+{
+#ifdef __SSE2__
+    __m128i control = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(value)));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < 16; i++)
+    {
+        if (group[i] == value)
+            mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+// Numbers hash by value, so that equal ones of different types, like 1,
+// 1.0 and True, are the same key
+size_t HashNumber(const ObjectHolder& value)
+{
+    if (std::optional<int> integer = ToExactInt(value))
+        return static_cast<size_t>(*integer);
+
+    // A BigInt and a Float no int equals are equal through their doubles
+    if (const Float* number = value.TryAs<Float>())
+        return std::hash<double>()(number->GetValue());
+    return std::hash<double>()(static_cast<const BigInt&>(*value).GetValue().ToDouble());
+}
+
+size_t HashInteger(const ObjectHolder& value)
+{
+    switch (GetTypeTag(value))
+    {
+    case TypeTag::Number:
+    case TypeTag::BigInt:
+        return HashNumber(value);
+    default:
+        throw std::runtime_error("__hash__ must return an integer");
+    }
+}
+
+}
+
+size_t HashKey(const ObjectHolder& key, Context& context)
+{
+    switch (GetTypeTag(key))
+    {
+    case TypeTag::None:
+        return 0;
+    case TypeTag::Number:
+    case TypeTag::BigInt:
+    case TypeTag::Bool:
+    case TypeTag::Float:
+        return HashNumber(key);
+    case TypeTag::String:
+        return static_cast<const String&>(*key).GetHash();
+    case TypeTag::Tuple:
+    {
+        size_t hash = 0x345678;
+        for (const ObjectHolder& item : static_cast<const Tuple&>(*key).GetItems())
+        {
+            hash = (hash ^ Mix(HashKey(item, context))) * 1000003;
+        }
+        return hash;
+    }
+    case TypeTag::Instance:
+    {
+        ObjectHolder object = key;
+        ClassInstance& instance = static_cast<ClassInstance&>(*object);
+        if (instance.HasMethod("__hash__", 0))
+        {
+            return HashInteger(instance.Call("__hash__", {}, context));
+        }
+        return std::hash<const Object*>()(object.Get());
+    }
+    default:
+        throw std::runtime_error("Unhashable type used as a key");
+    }
+}
+
+bool KeysEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context)
+{
+    if (std::optional<bool> equal = EqualNumbers(lhs, rhs))
+        return *equal;
+
+    TypeTag tag = GetTypeTag(lhs);
+    if (tag != GetTypeTag(rhs))
+        return false;
+
+    switch (tag)
+    {
+    case TypeTag::None:
+        return true;
+    case TypeTag::String:
+        return static_cast<const String&>(*lhs).GetValue() == static_cast<const String&>(*rhs).GetValue();
+    case TypeTag::Tuple:
+    {
+        std::span<const ObjectHolder> left = static_cast<const Tuple&>(*lhs).GetItems();
+        std::span<const ObjectHolder> right = static_cast<const Tuple&>(*rhs).GetItems();
+        return std::equal(left.begin(), left.end(), right.begin(), right.end(),
+            [&context](const ObjectHolder& a, const ObjectHolder& b) { return KeysEqual(a, b, context); });
+    }
+    case TypeTag::Instance:
+    {
+        if (lhs.Get() == rhs.Get())
+            return true;
+
+        ObjectHolder object = lhs;
+        ClassInstance& instance = static_cast<ClassInstance&>(*object);
+        return instance.HasMethod("__eq__", 1) && IsTrue(instance.Call("__eq__", std::span(&rhs, 1), context));
+    }
+    default:
+        return lhs.Get() == rhs.Get();
+    }
+}
+
+uint32_t Dict::FindEntry(const ObjectHolder& key, size_t hash, Context& context) const
+{
+    // The __eq__ of a key may change the dict, which starts the probe over
+    uint32_t index = NoEntry;
+    while (!TryFindEntry(key, hash, context, index))
+    {
+    }
+    return index;
+}
+
+bool Dict::TryFindEntry(const ObjectHolder& key, size_t hash, Context& context, uint32_t& index) const
+{
+    if (m_Entries.empty())
+        return true;
+
+    size_t version = m_Version;
+    size_t groupMask = m_Capacity / GroupSize - 1;
+    size_t group = (hash >> 7) & groupMask;
+
+    // Triangular probing over groups visits each of them once
+    for (size_t step = 1; ; step++)
+    {
+        const int8_t* control = m_Control.get() + group * GroupSize;
+
+        for (uint32_t match = MatchByte(control, HashTag(hash)); match; match &= match - 1)
+        {
+            uint32_t candidate = m_Slots[group * GroupSize + std::countr_zero(match)];
+            if (m_Entries[candidate].hash != hash)
+                continue;
+
+            // Held here, as __eq__ may drop the entry's reference
+            ObjectHolder candidateKey = m_Entries[candidate].key;
+            bool equal = KeysEqual(candidateKey, key, context);
+            if (m_Version != version)
+                return false;
+
+            if (equal)
+            {
+                index = candidate;
+                return true;
+            }
+        }
+
+        if (MatchByte(control, Empty))
+            return true;
+
+        group = (group + step) & groupMask;
+    }
+}
+
+const ObjectHolder* Dict::Find(const ObjectHolder& key, Context& context) const
+{
+    if (m_Entries.empty())
+        return nullptr;
+
+    uint32_t index = FindEntry(key, Mix(HashKey(key, context)), context);
+    return index != NoEntry ? &m_Entries[index].value : nullptr;
+}
+
+ObjectHolder Dict::Get(const ObjectHolder& key, Context& context) const
+{
+    if (const ObjectHolder* value = Find(key, context))
+        return *value;
+
+    throw std::runtime_error("Key not found in dict");
+}
+
+void Dict::Set(ObjectHolder key, ObjectHolder value, Context& context)
+{
+    size_t hash = Mix(HashKey(key, context));
+
+    if (uint32_t index = FindEntry(key, hash, context); index != NoEntry)
+    {
+        m_Entries[index].value = std::move(value);
+        return;
+    }
+
+    // Keep at least one slot in eight empty, so that probes stay short
+    if ((m_Entries.size() + 1) * 8 > m_Capacity * 7)
+    {
+        Rehash(m_Capacity ? m_Capacity * 2 : GroupSize);
+    }
+
+    Insert(hash, m_Entries.size());
+    m_Entries.push_back({hash, std::move(key), std::move(value)});
+}
+
+void Dict::Insert(size_t hash, uint32_t index)
+{
+    size_t groupMask = m_Capacity / GroupSize - 1;
+    size_t group = (hash >> 7) & groupMask;
+
+    for (size_t step = 1; ; step++)
+    {
+        if (uint32_t empty = MatchByte(m_Control.get() + group * GroupSize, Empty))
+        {
+            size_t slot = group * GroupSize + std::countr_zero(empty);
+            m_Control[slot] = HashTag(hash);
+            m_Slots[slot] = index;
+            m_Version++;
+            return;
+        }
+        group = (group + step) & groupMask;
+    }
+}
+
+void Dict::Rehash(size_t capacity)
+{
+    m_Capacity = capacity;
+    m_Control = std::make_unique<int8_t[]>(capacity);
+    m_Slots = std::make_unique<uint32_t[]>(capacity);
+    std::fill_n(m_Control.get(), capacity, Empty);
+
+    for (uint32_t index = 0; index < m_Entries.size(); index++)
+    {
+        Insert(m_Entries[index].hash, index);
+    }
+}
+
+ObjectHolder Dict::Call(const std::string& method, std::span<const ObjectHolder> actualParams, Context& context)
+{
+    if (method == "get" && (actualParams.size() == 1 || actualParams.size() == 2))
+    {
+        if (const ObjectHolder* value = Find(actualParams[0], context))
+            return *value;
+
+        return actualParams.size() == 2 ? actualParams[1] : ObjectHolder::None();
+    }
+    throw std::runtime_error("Dict has no method " + method + " taking " + std::to_string(actualParams.size()) + " arguments");
+}
+
+void Dict::Print(std::ostream& os, Context& context)
+{
+    if (m_Printing)
+    {
+        os << "{...}";
+        return;
+    }
+
+    m_Printing = true;
+    os << '{';
+    for (size_t i = 0; i < m_Entries.size(); i++)
+    {
+        if (i > 0)
+            os << ", ";
+
+        ObjectHolder value = m_Entries[i].value;
+        PrintRepr(os, m_Entries[i].key, context);
+        os << ": ";
+        PrintRepr(os, value, context);
+    }
+    os << '}';
+    m_Printing = false;
+}
+
+void Dict::Traverse(const Visitor& visit) const
+{
+    for (const Entry& entry : m_Entries)
+    {
+        visit(entry.key);
+        visit(entry.value);
+    }
+}
+
+void Dict::Clear()
+{
+    std::vector<Entry> entries;
+    entries.swap(m_Entries);
+    m_Control.reset();
+    m_Slots.reset();
+    m_Capacity = 0;
+    m_Version++;
+}
+
+}
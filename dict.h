@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "object.h"
+
+namespace Runtime {
+
+// Hashing and equality of dict keys. Strings, numbers and None hash by
+// value, instances through __hash__ and __eq__ or by identity when they
+// don't define __hash__. Numbers of different types are equal keys when
+// == has them equal, like 1, 1.0 and True, other keys of different types
+// never are.
+size_t HashKey(const ObjectHolder& key, Context& context);
+bool KeysEqual(const ObjectHolder& lhs, const ObjectHolder& rhs, Context& context);
+
+// Open addressing hash table in the style of Swiss tables. Slots are split
+// into groups of 16 with one control byte per slot, holding 7 bits of the
+// hash of a full slot, so a probe compares a whole group with one SIMD
+// comparison and only looks at the entries whose control byte matched.
+// The slots index into an array of entries kept in insertion order, which
+// is also the iteration order like in Python.
+class Dict : public Object, public Collectable
+{
+public:
+    Dict()
+        : Object(TypeTag::Dict)
+    {
+    }
+
+    size_t Size() const
+    {
+        return m_Entries.size();
+    }
+
+    // Keys in insertion order
+    const ObjectHolder& GetKey(size_t index) const
+    {
+        return m_Entries[index].key;
+    }
+
+    // Returns nullptr when the key is missing
+    const ObjectHolder* Find(const ObjectHolder& key, Context& context) const;
+    ObjectHolder Get(const ObjectHolder& key, Context& context) const;
+    void Set(ObjectHolder key, ObjectHolder value, Context& context);
+
+    bool Contains(const ObjectHolder& key, Context& context) const
+    {
+        return Find(key, context) != nullptr;
+    }
+
+    // Built-in methods: get(key), get(key, default)
+    ObjectHolder Call(const std::string& method, std::span<const ObjectHolder> actualParams, Context& context);
+
+    void Print(std::ostream& os, Context& context) override;
+
+    void Traverse(const Visitor& visit) const override;
+    void Clear() override;
+private:
+    static constexpr size_t GroupSize = 16;
+    static constexpr int8_t Empty = -128;
+
+    struct Entry
+    {
+        size_t hash;
+        ObjectHolder key;
+        ObjectHolder value;
+    };
+
+    static constexpr uint32_t NoEntry = UINT32_MAX;
+
+    // Index of the entry with the key, NoEntry when the key is missing
+    uint32_t FindEntry(const ObjectHolder& key, size_t hash, Context& context) const;
+    // False when the dict was changed during the probe by the __eq__ of a key
+    bool TryFindEntry(const ObjectHolder& key, size_t hash, Context& context, uint32_t& index) const;
+    void Rehash(size_t capacity);
+    // Puts the index of a new entry into the first empty slot for the hash
+    void Insert(size_t hash, uint32_t index);
+
+    static uint8_t HashTag(size_t hash)
+    {
+        return hash & 0x7f;
+    }
+
+    std::vector<Entry> m_Entries;
+    std::unique_ptr<int8_t[]> m_Control;
+    std::unique_ptr<uint32_t[]> m_Slots;
+    size_t m_Capacity = 0;
+    // Changed by every insertion and clearing, so that probes notice them
+    size_t m_Version = 0;
+    bool m_Printing = false;
+};
+
+template <>
+struct TaggedType<TypeTag::Dict>
+{
+    using Type = Dict;
+};
+
+template <>
+struct PoolTraits<Dict>
+{
+    static constexpr bool Pooled = true;
+    static constexpr const char* Name = "Dict";
+    static constexpr size_t BlocksPerChunk = 256;
+};
+
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include "object_holder.h"
+
+namespace AST {
+
+// Where a suspended generator body continues, and what it yielded last
+struct YieldState
+{
+    std::coroutine_handle<> leaf;
+    ObjectHolder value;
+};
+
+// Coroutine of a statement of a generator body. Statements await the
+// executions of the statements inside of them, and a yield suspends the
+// whole chain up to the generator, whose next resumption continues right at
+// the yield. Execution starts on the first resumption, and children are
+// switched to and back from without growing the stack.
+class Execution
+{
+public:
+    struct promise_type
+    {
+        std::coroutine_handle<> continuation;
+        YieldState* state = nullptr;
+        std::exception_ptr exception;
+
+        Execution get_return_object()
+        {
+            return Execution(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        auto final_suspend() noexcept
+        {
+            struct FinalAwaiter
+            {
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                {
+                    std::coroutine_handle<> continuation = handle.promise().continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+
+                void await_resume() noexcept
+                {
+                }
+            };
+            return FinalAwaiter{};
+        }
+
+        void return_void()
+        {
+        }
+
+        void unhandled_exception()
+        {
+            exception = std::current_exception();
+        }
+
+        // Frames come from pools of a few size classes, since loops in
+        // generators start one for every iteration of their bodies
+        static void* operator new(size_t size);
+        static void operator delete(void* frame, size_t size);
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    explicit Execution(Handle handle)
+        : m_Handle(handle)
+    {
+    }
+
+    Execution(Execution&& other) noexcept
+        : m_Handle(std::exchange(other.m_Handle, nullptr))
+    {
+    }
+
+    Execution& operator=(Execution&& other) noexcept
+    {
+        std::swap(m_Handle, other.m_Handle);
+        return *this;
+    }
+
+    ~Execution()
+    {
+        if (m_Handle)
+            m_Handle.destroy();
+    }
+
+    Handle GetHandle() const
+    {
+        return m_Handle;
+    }
+
+    // Makes the execution a child of the parent, which continues once the
+    // child is done, and returns the child to switch to
+    Handle AttachTo(Handle parent) const
+    {
+        m_Handle.promise().continuation = parent;
+        m_Handle.promise().state = parent.promise().state;
+        return m_Handle;
+    }
+
+    // Rethrows what escaped the statement, once the execution is done
+    void RethrowException() const
+    {
+        if (m_Handle.promise().exception)
+            std::rethrow_exception(m_Handle.promise().exception);
+    }
+private:
+    Handle m_Handle;
+};
+
+// Awaited by a yield, suspends the generator body with the value
+struct YieldAwaiter
+{
+    ObjectHolder value;
+
+    bool await_ready() noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(Execution::Handle handle) noexcept
+    {
+        YieldState& state = *handle.promise().state;
+        state.leaf = handle;
+        state.value = std::move(value);
+    }
+
+    void await_resume() noexcept
+    {
+    }
+};
+
+}
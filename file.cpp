@@ -0,0 +1,212 @@
+#include "file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Runtime {
+
+namespace {
+
+// Pipes rarely have more than this ready, and a line longer than a block
+// grows the block it's read into
+constexpr size_t BlockBytes = 1024 * 1024;
+
+// Unmapped once the file and all the strings that see it are gone
+class Mapping
+{
+public:
+    explicit Mapping(std::string_view text)
+        : m_Text(text)
+    {
+    }
+
+    Mapping(const Mapping&) = delete;
+    Mapping& operator=(const Mapping&) = delete;
+
+    ~Mapping()
+    {
+        munmap(const_cast<char*>(m_Text.data()), m_Text.size());
+    }
+
+    const std::string_view& GetText() const
+    {
+        return m_Text;
+    }
+private:
+    std::string_view m_Text;
+};
+
+std::runtime_error FileError(const std::string& what, const std::string& path)
+{
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+}
+
+File::File(std::string path)
+    : m_Path(std::move(path)), m_Contents(ObjectHolder::Own(String(std::string())))
+{
+    m_Fd = open(m_Path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_Fd < 0)
+        throw FileError("Cannot open", m_Path);
+
+    // Empty regular files can't be mapped, and some of /proc claim to be
+    // empty while they aren't, so those are read like pipes
+    struct stat info;
+    if (fstat(m_Fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0)
+        return;
+
+    size_t size = static_cast<size_t>(info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, m_Fd, 0);
+    if (data == MAP_FAILED)
+        return;
+
+    madvise(data, size, MADV_SEQUENTIAL);
+    auto mapping = std::make_shared<const Mapping>(std::string_view(static_cast<const char*>(data), size));
+    m_Contents = ObjectHolder::Own(String(std::shared_ptr<const std::string_view>(mapping, &mapping->GetText())));
+
+    // The mapping stays valid without the descriptor
+    close(m_Fd);
+    m_Fd = -1;
+}
+
+File::~File()
+{
+    if (m_Fd >= 0)
+        close(m_Fd);
+}
+
+ObjectHolder File::Read()
+{
+    if (!m_Contents)
+        throw std::runtime_error("Reading from closed file " + m_Path);
+
+    if (m_Fd >= 0)
+    {
+        // All of the rest goes into one buffer rather than one per block
+        std::string text(Unread());
+        size_t size = text.size();
+        while (true)
+        {
+            if (size == text.size())
+                text.resize(std::max(size * 2, size + BlockBytes));
+
+            ssize_t count = read(m_Fd, text.data() + size, text.size() - size);
+            if (count < 0 && errno != EINTR)
+                throw FileError("Cannot read", m_Path);
+            if (count == 0)
+                break;
+            if (count > 0)
+                size += count;
+        }
+        text.resize(size);
+
+        close(m_Fd);
+        m_Fd = -1;
+        m_Contents = ObjectHolder::Own(String(std::move(text)));
+        m_Position = 0;
+    }
+    return Take(Unread().size());
+}
+
+ObjectHolder File::ReadLine()
+{
+    if (!m_Contents)
+        throw std::runtime_error("Reading from closed file " + m_Path);
+
+    while (true)
+    {
+        std::string_view unread = Unread();
+        if (size_t end = unread.find('\n'); end != std::string_view::npos)
+            return Take(end + 1);
+
+        // The last line may have no '\n'
+        if (!ReadBlock())
+            return Take(unread.size());
+    }
+}
+
+void File::Close()
+{
+    if (m_Fd >= 0)
+        close(m_Fd);
+
+    m_Fd = -1;
+    m_Contents = ObjectHolder::None();
+}
+
+bool File::ReadBlock()
+{
+    if (m_Fd < 0)
+        return false;
+
+    // Each block is a new buffer, the strings handed out keep seeing the
+    // old one
+    std::string_view unread = Unread();
+    std::string block;
+    block.resize(std::max(BlockBytes, unread.size() * 2));
+    std::copy(unread.begin(), unread.end(), block.begin());
+
+    ssize_t count;
+    do
+    {
+        count = read(m_Fd, block.data() + unread.size(), block.size() - unread.size());
+    } while (count < 0 && errno == EINTR);
+
+    if (count < 0)
+        throw FileError("Cannot read", m_Path);
+
+    if (count == 0)
+    {
+        close(m_Fd);
+        m_Fd = -1;
+        return false;
+    }
+
+    block.resize(unread.size() + count);
+    m_Contents = ObjectHolder::Own(String(std::move(block)));
+    m_Position = 0;
+    return true;
+}
+
+std::string_view File::Unread() const
+{
+    return static_cast<const String&>(*m_Contents).GetValue().substr(m_Position);
+}
+
+ObjectHolder File::Take(size_t size)
+{
+    size_t begin = m_Position;
+    m_Position += size;
+    return ObjectHolder::Own(static_cast<const String&>(*m_Contents).Slice(begin, m_Position));
+}
+
+ObjectHolder File::Call(const std::string& method, std::span<const ObjectHolder> actualParams)
+{
+    if (actualParams.empty())
+    {
+        if (method == "read")
+            return Read();
+        if (method == "readline")
+            return ReadLine();
+        if (method == "close")
+        {
+            Close();
+            return ObjectHolder::None();
+        }
+    }
+    throw std::runtime_error("File has no method " + method + " taking " + std::to_string(actualParams.size()) + " arguments");
+}
+
+void File::Print(std::ostream& os, Context& context)
+{
+    os << "File " << m_Path;
+}
+
+}
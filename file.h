@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "object.h"
+
+namespace Runtime {
+
+// File opened for reading with open(path). Regular files are mapped into
+// memory, and what read() and readline() return are slices of the mapping.
+// Pipes, terminals and the like are read in large blocks, and the lines
+// are slices of the blocks unless they cross into the next one.
+class File : public Object
+{
+public:
+    explicit File(std::string path);
+    ~File() override;
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+
+    // The rest of the file
+    ObjectHolder Read();
+    // The next line with its '\n', and an empty string at the end
+    ObjectHolder ReadLine();
+    void Close();
+
+    // Built-in methods: read(), readline(), close()
+    ObjectHolder Call(const std::string& method, std::span<const ObjectHolder> actualParams);
+
+    void Print(std::ostream& os, Context& context) override;
+private:
+    // Reads the next block after the unread part of the current one, false
+    // at the end of the file
+    bool ReadBlock();
+    std::string_view Unread() const;
+    ObjectHolder Take(size_t size);
+
+    std::string m_Path;
+    int m_Fd = -1;
+    // The mapping of a regular file or the current block of any other
+    ObjectHolder m_Contents;
+    size_t m_Position = 0;
+};
+
+}
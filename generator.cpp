@@ -0,0 +1,113 @@
+#include "generator.h"
+#include "ast.h"
+#include "pool.h"
+
+#include <array>
+#include <stdexcept>
+
+namespace AST {
+
+namespace {
+
+constexpr size_t FrameClassBytes = 128;
+constexpr size_t FrameClasses = 8;
+
+// Frames up to 1KB, bigger ones come from the global allocator
+Runtime::Pool* GetFramePool(size_t size)
+{
+    size_t index = (size - 1) / FrameClassBytes;
+    if (index >= FrameClasses)
+        return nullptr;
+
+    // Never destroyed, generators may outlive static destructors
+    static auto* pools = new std::array<Runtime::Pool*, FrameClasses>();
+    Runtime::Pool*& pool = (*pools)[index];
+    if (!pool)
+        pool = new Runtime::Pool("Frame" + std::to_string((index + 1) * FrameClassBytes), (index + 1) * FrameClassBytes, 64);
+    return pool;
+}
+
+}
+
+void* Execution::promise_type::operator new(size_t size)
+{
+    if (Runtime::Pool* pool = GetFramePool(size))
+        return pool->Allocate();
+    return ::operator new(size);
+}
+
+void Execution::promise_type::operator delete(void* frame, size_t size)
+{
+    if (Runtime::Pool* pool = GetFramePool(size))
+        pool->Deallocate(frame);
+    else
+        ::operator delete(frame);
+}
+
+}
+
+namespace Runtime {
+
+Generator::Generator(Closure closure, AST::Node& body)
+    : m_Closure(std::move(closure))
+{
+    m_Execution.emplace(body.Execute(m_Closure, m_Context));
+    m_Execution->GetHandle().promise().state = &m_State;
+}
+
+std::optional<ObjectHolder> Generator::Next()
+{
+    if (!m_Execution)
+        return std::nullopt;
+
+    if (m_Running)
+        throw std::runtime_error("Generator is already running");
+
+    // Continues at the last yield, or starts the body the first time
+    std::coroutine_handle<> handle = m_State.leaf ? m_State.leaf : m_Execution->GetHandle();
+    m_Running = true;
+    handle.resume();
+    m_Running = false;
+
+    AST::Execution::Handle root = m_Execution->GetHandle();
+    if (!root.done())
+        return std::move(m_State.value);
+
+    // A return ends the generator like the end of its body does, a raise
+    // goes on to the consumer
+    std::exception_ptr exception = root.promise().exception;
+    bool raised = m_Context.GetCompletion() == Completion::Raise;
+    ObjectHolder raisedException = m_Context.TakeException();
+    m_Execution.reset();
+    m_Closure.clear();
+    m_Context = Context();
+
+    if (exception)
+        std::rethrow_exception(exception);
+    if (raised)
+        throw Raised(std::move(raisedException));
+    return std::nullopt;
+}
+
+void Generator::Print(std::ostream& os, Context& context)
+{
+    os << "Generator";
+}
+
+void Generator::Traverse(const Visitor& visit) const
+{
+    for (const auto& [name, value] : m_Closure)
+    {
+        visit(value);
+    }
+}
+
+void Generator::Clear()
+{
+    // The frames refer to the closure, so they go first
+    m_Execution.reset();
+    Closure closure;
+    closure.swap(m_Closure);
+}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <optional>
+#include "object.h"
+#include "execution.h"
+
+namespace Runtime {
+
+// Result of calling a method or a function with a yield in its body. The
+// body runs up to its next yield whenever the next item is asked for, in
+// the closure of the call, which the generator owns from then on. The body
+// has a context of its own, so that its returns never reach the consumer.
+class Generator : public Object, public Collectable
+{
+public:
+    Generator(Closure closure, AST::Node& body);
+
+    // The next yielded value, nothing once the body has finished
+    std::optional<ObjectHolder> Next();
+
+    void Print(std::ostream& os, Context& context) override;
+
+    void Traverse(const Visitor& visit) const override;
+    void Clear() override;
+private:
+    Closure m_Closure;
+    Context m_Context;
+    AST::YieldState m_State;
+    std::optional<AST::Execution> m_Execution;
+    bool m_Running = false;
+};
+
+}
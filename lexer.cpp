@@ -1,8 +1,11 @@
 #include <algorithm>
+#include <charconv>
+#include <cstdlib>
 #include <unordered_map>
 #include <string>
 #include <iomanip>
 #include "lexer.h"
+#include "allocation_counter.h"
 
 const int Reader::Eof = std::istream::traits_type::eof();
 
@@ -13,9 +16,19 @@ int Reader::Next()
 
     m_Column++;
 
-    char ch;
-    if (m_Line >> std::noskipws >> ch)
-        return ch;
+    if (m_Position < m_Line.size())
+        return m_Line[m_Position++];
+
+    return '\n';
+}
+
+int Reader::Peek() const
+{
+    if (!m_Input)
+        return Eof;
+
+    if (m_Position < m_Line.size())
+        return m_Line[m_Position];
 
     return '\n';
 }
@@ -24,25 +37,27 @@ void Reader::NextLine()
 {
     auto isSpace = [](char c) { return std::isspace(c); };
 
-    for (std::string line; std::getline(m_Input, line); )
+    while (std::getline(m_Input, m_Line))
     {
         m_Lineno++;
 
-        auto it = std::find_if_not(line.begin(), line.end(), isSpace);
-        if (it != line.end())
+        auto it = std::find_if_not(m_Line.begin(), m_Line.end(), isSpace);
+        if (it != m_Line.end() && *it != '#')
         {
-            int spacesCount = it - line.begin();
+            int spacesCount = it - m_Line.begin();
 
             if (spacesCount % 2 == 1)
-                throw std::runtime_error("Odd number of spaces in line: " + line);
+                throw std::runtime_error("Odd number of spaces in line: " + m_Line);
 
             m_Indent = spacesCount / 2;
-            m_Line = std::istringstream(std::string(it, line.end()));
+            m_Position = spacesCount;
             m_Column = 0;
             return;
         }
     }
 
+    m_Line.clear();
+    m_Position = 0;
     m_Column = 0;
     m_Indent = 0;
 }
@@ -54,16 +69,29 @@ void Lexer::Advance()
 
 Token Lexer::GetNextToken()
 {
+    AllocationCounter::Scope scope(AllocationCounter::Phase::Lex);
+
     static const std::unordered_map<std::string, Token> keywords = {
         {"class", Token{Tokens::Class{}}},
         {"def", Token{Tokens::Def{}}},
         {"return", Token{Tokens::Return{}}},
+        {"yield", Token{Tokens::Yield{}}},
+        {"try", Token{Tokens::Try{}}},
+        {"except", Token{Tokens::Except{}}},
+        {"raise", Token{Tokens::Raise{}}},
+        {"as", Token{Tokens::As{}}},
+        {"import", Token{Tokens::Import{}}},
         {"print", Token{Tokens::Print{}}},
         {"if", Token{Tokens::If{}}},
         {"else", Token{Tokens::Else{}}},
+        {"while", Token{Tokens::While{}}},
+        {"for", Token{Tokens::For{}}},
+        {"break", Token{Tokens::Break{}}},
+        {"continue", Token{Tokens::Continue{}}},
         {"and", Token{Tokens::And{}}},
         {"or", Token{Tokens::Or{}}},
         {"not", Token{Tokens::Not{}}},
+        {"in", Token{Tokens::In{}}},
         {"True", Token{Tokens::True{}}},
         {"False", Token{Tokens::False{}}},
         {"None", Token{Tokens::None{}}},
@@ -94,25 +122,92 @@ Token Lexer::GetNextToken()
                 Advance();
             } while (std::isspace(m_CurrentChar));
         }
+        else if (m_CurrentChar == '#')
+        {
+            do
+            {
+                Advance();
+            } while (m_CurrentChar != '\n');
+        }
         else if (std::isdigit(m_CurrentChar))
         {
-            int value = 0;
+            std::string digits;
             do
             {
-                value = value * 10 + m_CurrentChar - '0';
+                digits += m_CurrentChar;
                 Advance();
             } while (std::isdigit(m_CurrentChar));
 
-            return Token{Tokens::Integer{std::move(value)}};
+            // A point only starts a fraction when a digit follows it
+            bool isFloat = false;
+            if (m_CurrentChar == '.' && std::isdigit(m_Reader.Peek()))
+            {
+                isFloat = true;
+                do
+                {
+                    digits += m_CurrentChar;
+                    Advance();
+                } while (std::isdigit(m_CurrentChar));
+            }
+
+            if ((m_CurrentChar == 'e' || m_CurrentChar == 'E')
+                && (std::isdigit(m_Reader.Peek()) || m_Reader.Peek() == '-' || m_Reader.Peek() == '+'))
+            {
+                isFloat = true;
+                digits += m_CurrentChar;
+                Advance();
+                if (m_CurrentChar == '-' || m_CurrentChar == '+')
+                {
+                    digits += m_CurrentChar;
+                    Advance();
+                }
+
+                if (!std::isdigit(m_CurrentChar))
+                    throw std::runtime_error("Malformed float literal " + digits);
+
+                do
+                {
+                    digits += m_CurrentChar;
+                    Advance();
+                } while (std::isdigit(m_CurrentChar));
+            }
+
+            if (isFloat)
+            {
+                double value = 0;
+                auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+
+                // from_chars leaves the value alone when it's out of range,
+                // strtod gives inf for an overflow and 0.0 for an underflow
+                if (error == std::errc::result_out_of_range)
+                    value = std::strtod(digits.c_str(), nullptr);
+                else if (error != std::errc() || end != digits.data() + digits.size())
+                    throw std::runtime_error("Malformed float literal " + digits);
+
+                return Token{Tokens::Float{value}};
+            }
+
+            int value = 0;
+            auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+
+            if (error == std::errc::result_out_of_range)
+                return Token{Tokens::LongInteger{std::move(digits)}};
+
+            return Token{Tokens::Integer{value}};
         }
-        else if (std::isalpha(m_CurrentChar))
+        else if (std::isalpha(m_CurrentChar) || m_CurrentChar == '_')
         {
             std::string value;
             do
             {
                 value += m_CurrentChar;
                 Advance();
-            } while (std::isalnum(m_CurrentChar));
+            } while (std::isalnum(m_CurrentChar) || m_CurrentChar == '_');
+
+            if (value == "f" && (m_CurrentChar == '"' || m_CurrentChar == '\''))
+            {
+                return LexFormatString();
+            }
 
             if (auto it = keywords.find(value); it != keywords.end())
             {
@@ -217,6 +312,26 @@ Token Lexer::GetNextToken()
             Advance();
             return Token{Tokens::Rparen{}};
         }
+        else if (m_CurrentChar == '[')
+        {
+            Advance();
+            return Token{Tokens::Lbracket{}};
+        }
+        else if (m_CurrentChar == ']')
+        {
+            Advance();
+            return Token{Tokens::Rbracket{}};
+        }
+        else if (m_CurrentChar == '{')
+        {
+            Advance();
+            return Token{Tokens::Lbrace{}};
+        }
+        else if (m_CurrentChar == '}')
+        {
+            Advance();
+            return Token{Tokens::Rbrace{}};
+        }
         else if (m_CurrentChar == ':')
         {
             Advance();
@@ -232,11 +347,85 @@ Token Lexer::GetNextToken()
             Advance();
             return Token{Tokens::Dot{}};
         }
+        else if (m_CurrentChar == '@')
+        {
+            Advance();
+            return Token{Tokens::At{}};
+        }
         else
         {
             throw std::runtime_error("Unxpected token");
         }
     }
 
+    if (m_CurrentIndent > 0)
+    {
+        m_CurrentIndent--;
+        return Token{Tokens::Dedent{}};
+    }
+
     return Token{Tokens::Eof{}};
 }
+
+Token Lexer::LexFormatString()
+{
+    // Doubled braces stand for themselves, single ones enclose an expression
+    char opener = m_CurrentChar;
+    Tokens::FormatString result;
+    result.literals.emplace_back();
+
+    Advance();
+    while (m_CurrentChar != opener && m_CurrentChar != '\n')
+    {
+        char c = m_CurrentChar;
+        Advance();
+
+        if (c == '\\')
+        {
+            result.literals.back() += m_CurrentChar;
+            Advance();
+        }
+        else if ((c == '{' || c == '}') && m_CurrentChar == c)
+        {
+            result.literals.back() += c;
+            Advance();
+        }
+        else if (c == '}')
+        {
+            throw std::runtime_error("Single } in f-string");
+        }
+        else if (c == '{')
+        {
+            // Braces of dict literals nest inside of the expression
+            std::string hole;
+            int depth = 0;
+            while (m_CurrentChar != '\n' && m_CurrentChar != opener && (depth > 0 || m_CurrentChar != '}'))
+            {
+                depth += (m_CurrentChar == '{') - (m_CurrentChar == '}');
+                hole += m_CurrentChar;
+                Advance();
+            }
+
+            if (m_CurrentChar != '}')
+                throw std::runtime_error("f-string expression is missing its closing }");
+            Advance();
+
+            size_t begin = hole.find_first_not_of(' ');
+            if (begin == std::string::npos)
+                throw std::runtime_error("Empty expression in f-string");
+
+            result.holes.push_back(hole.substr(begin, hole.find_last_not_of(' ') + 1 - begin));
+            result.literals.emplace_back();
+        }
+        else
+        {
+            result.literals.back() += c;
+        }
+    }
+
+    if (m_CurrentChar != opener)
+        throw std::runtime_error("f-string has unbalanced quotes");
+
+    Advance();
+    return Token{std::move(result)};
+}
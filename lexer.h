@@ -1,19 +1,21 @@
 #pragma once
 
 #include <iostream>
-#include <sstream>
+#include <string>
 #include "token.h"
 
 class Reader
 {
 public:
     Reader(std::istream& input)
-        : m_Input(input), m_Lineno(0), m_Column(0), m_Indent(0)
+        : m_Input(input), m_Position(0), m_Lineno(0), m_Column(0), m_Indent(0)
     {
         NextLine();
     }
 
     int Next();
+    // The character Next would return, without consuming it
+    int Peek() const;
     void NextLine();
 
     int GetLineno() const
@@ -35,7 +37,9 @@ public:
 private:
 private:
     std::istream& m_Input;
-    std::istringstream m_Line;
+    // Reused for every line, so reading doesn't allocate once it's big enough
+    std::string m_Line;
+    size_t m_Position;
     int m_Lineno;
     int m_Column;
     int m_Indent;
@@ -53,6 +57,8 @@ public:
     Token GetNextToken();
 
 private:
+    Token LexFormatString();
+
     Reader m_Reader;
     char m_CurrentChar;
     int m_CurrentIndent;
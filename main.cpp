@@ -1,33 +1,118 @@
 #include <iostream>
+#include <filesystem>
 #include <fstream>
 #include <memory>
+#include <string>
 #include "token.h"
 #include "lexer.h"
 #include "parser.h"
 #include "object_holder.h"
 #include "ast.h"
+#include "pool.h"
+#include "collector.h"
+#include "memo.h"
+#include "module.h"
+#include "native.h"
+#include "allocation_counter.h"
 
-int main()
+int main(int argc, char* argv[])
 {
-    std::ifstream file("test.py");
-    Lexer lexer(file);
+    bool dumpTokens = false;
+    bool printStats = false;
+    std::string path = "test.py";
 
-    while (true)
+    for (int i = 1; i < argc; i++)
     {
-        static const Token Eof = Token{Tokens::Eof{}};
-        Token token = lexer.GetNextToken();
-
-        if (token == Eof)
-            break;
+        std::string arg = argv[i];
+        if (arg == "--tokens")
+            dumpTokens = true;
+        else if (arg == "--stats")
+            printStats = true;
+        else if (arg == "--math")
+            Runtime::RegisterMath(Runtime::Extensions::Get());
+        else if (arg == "--no-simd")
+            Runtime::Kernels::SetAvx2Enabled(false);
+        else if (arg == "--flush=line")
+            AST::Print::GetOutput().SetFlushPolicy(Runtime::FlushPolicy::Line);
+        else if (arg == "--flush=block")
+            AST::Print::GetOutput().SetFlushPolicy(Runtime::FlushPolicy::Block);
+        else if (arg == "--flush=exit")
+            AST::Print::GetOutput().SetFlushPolicy(Runtime::FlushPolicy::OnExit);
+        else if (arg.rfind("--gc-threshold=", 0) == 0)
+            Runtime::Collector::Get().SetThreshold(std::stoul(arg.substr(arg.find('=') + 1)));
+        else
+            path = std::move(arg);
+    }
 
-        std::cout << token;
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "Cannot open " << path << '\n';
+        return 1;
     }
 
-    // Parser parser(lexer);
+    Modules::Get().SetSearchPath(std::filesystem::path(path).parent_path());
+
+    try
+    {
+        Lexer lexer(file);
+
+        if (dumpTokens)
+        {
+            while (true)
+            {
+                static const Token Eof = Token{Tokens::Eof{}};
+                Token token = lexer.GetNextToken();
+
+                if (token == Eof)
+                    break;
 
-    // Runtime::Closure closure;
-    // std::unique_ptr<AST::Node> tree = parser.ParseProgram();
+                std::cout << token;
+            }
+            return 0;
+        }
 
-    // ObjectHolder result = tree->Evaluate(closure);
-    // std::cout << closure;
+        Parser parser(lexer);
+
+        Runtime::Closure closure;
+        Runtime::Context context;
+        std::unique_ptr<AST::Node> tree = parser.ParseProgram();
+
+        {
+            AllocationCounter::Scope scope(AllocationCounter::Phase::Eval);
+            try
+            {
+                tree->Evaluate(closure, context);
+            }
+            catch (const Runtime::Raised& raised)
+            {
+                context.SetRaise(raised.GetException());
+            }
+        }
+
+        // Printed while the classes of the program are still there
+        if (context.GetCompletion() == Runtime::Completion::Raise)
+        {
+            std::string text = "Uncaught exception ";
+            Runtime::AppendStr(text, context.TakeException(), context);
+            throw std::runtime_error(text);
+        }
+        AST::Print::GetOutput().Flush();
+
+        if (printStats)
+        {
+            Runtime::PrintPoolStatistics(std::cerr);
+            Runtime::PrintCollectorStatistics(std::cerr);
+            Runtime::PrintMemoStatistics(std::cerr);
+            PrintModuleStatistics(std::cerr);
+            AllocationCounter::Print(std::cerr);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        // What the program printed comes before the error
+        AST::Print::GetOutput().Flush();
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
 }
@@ -0,0 +1,158 @@
+#include "memo.h"
+#include "object.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Runtime {
+
+namespace {
+
+std::vector<Memo*>& Memos()
+{
+    static std::vector<Memo*>* memos = new std::vector<Memo*>();
+    return *memos;
+}
+
+template <typename T>
+void AppendBytes(std::string& key, T value)
+{
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    key.append(bytes, sizeof(T));
+}
+
+// A type byte and the value, strings and tuples are prefixed with their
+// sizes so that no two argument lists make the same key
+bool AppendKey(std::string& key, const ObjectHolder& arg)
+{
+    TypeTag tag = GetTypeTag(arg);
+    key.push_back(static_cast<char>(tag));
+
+    switch (tag)
+    {
+    case TypeTag::None:
+        return true;
+    case TypeTag::Number:
+        AppendBytes(key, static_cast<const Number&>(*arg).GetValue());
+        return true;
+    case TypeTag::Bool:
+        key.push_back(static_cast<const Bool&>(*arg).GetValue());
+        return true;
+    case TypeTag::Float:
+        AppendBytes(key, static_cast<const Float&>(*arg).GetValue());
+        return true;
+    case TypeTag::String:
+    {
+        std::string_view value = static_cast<const String&>(*arg).GetValue();
+        AppendBytes(key, value.size());
+        key.append(value);
+        return true;
+    }
+    case TypeTag::BigInt:
+    {
+        std::string digits = static_cast<const BigInt&>(*arg).GetValue().ToString();
+        AppendBytes(key, digits.size());
+        key.append(digits);
+        return true;
+    }
+    case TypeTag::Tuple:
+    {
+        std::span<const ObjectHolder> items = static_cast<const Tuple&>(*arg).GetItems();
+        AppendBytes(key, items.size());
+        return std::all_of(items.begin(), items.end(), [&key](const ObjectHolder& item) {
+            return AppendKey(key, item);
+        });
+    }
+    default:
+        return false;
+    }
+}
+
+}
+
+Memo::Memo(std::string name, size_t capacity)
+    : m_Name(std::move(name))
+{
+    m_Statistics.capacity = std::max<size_t>(capacity, 1);
+    Memos().push_back(this);
+}
+
+Memo::~Memo()
+{
+    std::vector<Memo*>& memos = Memos();
+    memos.erase(std::find(memos.begin(), memos.end(), this));
+}
+
+bool Memo::MakeKey(std::span<const ObjectHolder> args, std::string& key)
+{
+    for (const ObjectHolder& arg : args)
+    {
+        if (!AppendKey(key, arg))
+        {
+            m_Statistics.bypasses++;
+            return false;
+        }
+    }
+    return true;
+}
+
+const ObjectHolder* Memo::Find(const std::string& key)
+{
+    auto it = m_Index.find(key);
+    if (it == m_Index.end())
+    {
+        m_Statistics.misses++;
+        return nullptr;
+    }
+
+    m_Statistics.hits++;
+    m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+    return &it->second->result;
+}
+
+void Memo::Insert(std::string key, ObjectHolder result)
+{
+    // The call may have filled in the same key through recursion
+    if (auto it = m_Index.find(key); it != m_Index.end())
+    {
+        it->second->result = std::move(result);
+        return;
+    }
+
+    if (m_Entries.size() == m_Statistics.capacity)
+    {
+        m_Index.erase(m_Entries.back().key);
+        m_Entries.pop_back();
+        m_Statistics.evictions++;
+    }
+
+    m_Entries.push_front({std::move(key), std::move(result)});
+    m_Index.emplace(m_Entries.front().key, m_Entries.begin());
+    m_Statistics.size = m_Entries.size();
+}
+
+const std::vector<Memo*>& Memo::GetMemos()
+{
+    return Memos();
+}
+
+void PrintMemoStatistics(std::ostream& os)
+{
+    if (Memo::GetMemos().empty())
+        return;
+
+    os << "Memos" << '\n';
+    for (const Memo* memo : Memo::GetMemos())
+    {
+        const MemoStatistics& stats = memo->GetStatistics();
+        os << memo->GetName() << ": "
+           << "size " << stats.size << " / " << stats.capacity << ", "
+           << "hits " << stats.hits << ", "
+           << "misses " << stats.misses << ", "
+           << "evictions " << stats.evictions << ", "
+           << "bypasses " << stats.bypasses << '\n';
+    }
+}
+
+}
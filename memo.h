@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "object_holder.h"
+
+namespace Runtime {
+
+struct MemoStatistics
+{
+    size_t capacity = 0;
+    size_t size = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    // Calls with an argument that isn't a value, which always run
+    size_t bypasses = 0;
+};
+
+// Results of a @memoize method or function, keyed by the values of the
+// arguments. The least recently used result is dropped once the memo is
+// full. Only numbers, strings, bools, None and tuples of them make keys,
+// calls with anything else run every time. Methods remember their results
+// for each instance apart.
+class Memo
+{
+public:
+    Memo(std::string name, size_t capacity);
+    ~Memo();
+    Memo(const Memo&) = delete;
+    Memo& operator=(const Memo&) = delete;
+
+    // Encodes the arguments into key, false when one of them can't be a key
+    bool MakeKey(std::span<const ObjectHolder> args, std::string& key);
+
+    // The remembered result, nullptr on a miss
+    const ObjectHolder* Find(const std::string& key);
+    void Insert(std::string key, ObjectHolder result);
+
+    const std::string& GetName() const
+    {
+        return m_Name;
+    }
+
+    const MemoStatistics& GetStatistics() const
+    {
+        return m_Statistics;
+    }
+
+    static const std::vector<Memo*>& GetMemos();
+private:
+    struct Entry
+    {
+        std::string key;
+        ObjectHolder result;
+    };
+
+    std::string m_Name;
+    // Most recently used first, the index points into the list nodes
+    std::list<Entry> m_Entries;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> m_Index;
+    MemoStatistics m_Statistics;
+};
+
+void PrintMemoStatistics(std::ostream& os);
+
+}
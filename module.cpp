@@ -0,0 +1,109 @@
+#include "module.h"
+#include "parser.h"
+#include "allocation_counter.h"
+
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+
+Modules& Modules::Get()
+{
+    // Never destroyed, the classes of the modules outlive the program's
+    static Modules* modules = new Modules();
+    return *modules;
+}
+
+const Module& Modules::Import(const std::string& name)
+{
+    if (auto it = m_Index.find(name); it != m_Index.end())
+    {
+        Module& module = *it->second;
+        if (module.loading)
+            throw std::runtime_error("Module " + name + " is imported while it's being loaded");
+
+        module.imports++;
+        return module;
+    }
+
+    auto module = std::make_unique<Module>();
+    module->name = name;
+    module->path = m_SearchPath / (name + ".py");
+    module->imports = 1;
+    m_Index.emplace(name, module.get());
+
+    try
+    {
+        Load(*module);
+    }
+    catch (const std::runtime_error& e)
+    {
+        m_Index.erase(name);
+        throw std::runtime_error("Module " + name + ": " + e.what());
+    }
+
+    m_Modules.push_back(std::move(module));
+    return *m_Modules.back();
+}
+
+void Modules::Load(Module& module)
+{
+    std::ifstream file(module.path);
+    if (!file)
+        throw std::runtime_error("Cannot open " + module.path.string());
+
+    auto start = std::chrono::steady_clock::now();
+    double nestedMs = m_LoadTimeMs;
+
+    Lexer lexer(file);
+    Parser parser(lexer);
+    module.tree = parser.ParseProgram();
+    module.classes = parser.GetDefinedClasses();
+    module.functions = parser.GetDefinedFunctions();
+
+    auto parsed = std::chrono::steady_clock::now();
+    nestedMs = m_LoadTimeMs - nestedMs;
+
+    // Run in a closure and context of its own, like a program is
+    {
+        AllocationCounter::Scope scope(AllocationCounter::Phase::Eval);
+        Runtime::Closure closure;
+        Runtime::Context context;
+        try
+        {
+            module.tree->Evaluate(closure, context);
+        }
+        catch (const Runtime::Raised& raised)
+        {
+            context.SetRaise(raised.GetException());
+        }
+
+        if (context.GetCompletion() == Runtime::Completion::Raise)
+        {
+            std::string text = "Uncaught exception ";
+            Runtime::AppendStr(text, context.TakeException(), context);
+            throw std::runtime_error(text);
+        }
+    }
+
+    std::chrono::duration<double, std::milli> parseTime = parsed - start;
+    std::chrono::duration<double, std::milli> runTime = std::chrono::steady_clock::now() - parsed;
+    module.parseTimeMs = parseTime.count() - nestedMs;
+    module.runTimeMs = runTime.count();
+    module.loading = false;
+    m_LoadTimeMs += module.parseTimeMs + module.runTimeMs;
+}
+
+void PrintModuleStatistics(std::ostream& os)
+{
+    if (Modules::Get().GetModules().empty())
+        return;
+
+    os << "Modules" << '\n';
+    for (const auto& module : Modules::Get().GetModules())
+    {
+        os << module->name << ": "
+           << "parse " << module->parseTimeMs << "ms, "
+           << "run " << module->runTimeMs << "ms, "
+           << "imports " << module->imports << '\n';
+    }
+}
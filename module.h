@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "object.h"
+
+namespace AST {
+class Node;
+}
+
+// A script loaded by import. It's parsed and run on its first import, every
+// later importer gets the same class and function objects.
+struct Module
+{
+    std::string name;
+    std::filesystem::path path;
+    // What the module defines itself, not what it imports
+    Runtime::Closure classes;
+    Runtime::Closure functions;
+    // Kept for the whole process, like the classes and functions are
+    std::unique_ptr<AST::Node> tree;
+    // Loading times, without the modules this one imports
+    double parseTimeMs = 0;
+    double runTimeMs = 0;
+    size_t imports = 0;
+    bool loading = true;
+};
+
+// Modules of the process, by name. Names are resolved to name.py in the
+// directory of the main script.
+class Modules
+{
+public:
+    static Modules& Get();
+
+    void SetSearchPath(std::filesystem::path directory)
+    {
+        m_SearchPath = std::move(directory);
+    }
+
+    // Loads the module on its first import
+    const Module& Import(const std::string& name);
+
+    // In the order they were loaded in
+    const std::vector<std::unique_ptr<Module>>& GetModules() const
+    {
+        return m_Modules;
+    }
+private:
+    void Load(Module& module);
+
+    std::filesystem::path m_SearchPath;
+    std::unordered_map<std::string, Module*> m_Index;
+    std::vector<std::unique_ptr<Module>> m_Modules;
+    // Loading time of every module so far, taken off the parsing time of
+    // the module whose parsing imported them
+    double m_LoadTimeMs = 0;
+};
+
+void PrintModuleStatistics(std::ostream& os);
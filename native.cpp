@@ -0,0 +1,132 @@
+#include "native.h"
+#include "object.h"
+#include "ast.h"
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace Runtime {
+
+void RegisterMath(Extensions& extensions)
+{
+    extensions.AddClass("Math");
+
+    extensions.AddMethod("Math", "gcd", {"a", "b"}, [](ClassInstance&, const NativeArgs& args, Context&) {
+        return ObjectHolder::Own(Number(std::gcd(args.GetNumber(0), args.GetNumber(1))));
+    });
+
+    extensions.AddMethod("Math", "isqrt", {"n"}, [](ClassInstance&, const NativeArgs& args, Context&) {
+        int n = args.GetNumber(0);
+        if (n < 0)
+            throw std::runtime_error("isqrt() of a negative number");
+
+        // Newton's method from above, in long long so that r * r can't overflow
+        long long r = n;
+        while (r * r > n)
+        {
+            r = (r + n / r) / 2;
+        }
+        return ObjectHolder::Own(Number(static_cast<int>(r)));
+    });
+
+    extensions.AddMethod("Math", "parse", {"s"}, [](ClassInstance&, const NativeArgs& args, Context&) {
+        std::string_view text = args.GetString(0);
+        int value = 0;
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (error != std::errc() || end != text.data() + text.size())
+            throw std::runtime_error("Cannot parse " + std::string(text) + " as an int");
+        return ObjectHolder::Own(Number(value));
+    });
+
+    extensions.AddMethod("Math", "abs", {"n"}, [](ClassInstance&, const NativeArgs& args, Context&) {
+        int n = args.GetNumber(0);
+        if (n == std::numeric_limits<int>::min())
+            throw std::runtime_error("abs() overflows");
+        return ObjectHolder::Own(Number(n < 0 ? -n : n));
+    });
+}
+
+int NativeArgs::GetNumber(size_t index) const
+{
+    if (const Number* number = m_Args[index].TryAs<Number>())
+        return number->GetValue();
+    throw std::runtime_error("Argument " + std::to_string(index + 1) + " of " + m_Method + " must be an int");
+}
+
+std::string_view NativeArgs::GetString(size_t index) const
+{
+    if (const String* str = m_Args[index].TryAs<String>())
+        return str->GetValue();
+    throw std::runtime_error("Argument " + std::to_string(index + 1) + " of " + m_Method + " must be a string");
+}
+
+bool NativeArgs::GetBool(size_t index) const
+{
+    if (const Bool* value = m_Args[index].TryAs<Bool>())
+        return value->GetValue();
+    throw std::runtime_error("Argument " + std::to_string(index + 1) + " of " + m_Method + " must be a bool");
+}
+
+Extensions& Extensions::Get()
+{
+    // Never destroyed, like the pools
+    static Extensions* extensions = new Extensions();
+    return *extensions;
+}
+
+void Extensions::AddMethod(const std::string& className, std::string name, std::vector<std::string> formalParams, NativeFunction function)
+{
+    if (m_Classes)
+        throw std::runtime_error("Native method " + name + " is registered after parsing");
+
+    m_Methods[className].push_back({std::move(name), std::move(formalParams), std::move(function)});
+}
+
+void Extensions::AddClass(std::string name)
+{
+    if (m_Classes)
+        throw std::runtime_error("Builtin class " + name + " is registered after parsing");
+
+    m_ClassNames.push_back(std::move(name));
+}
+
+const Closure& Extensions::GetClasses()
+{
+    if (!m_Classes)
+    {
+        m_Classes.emplace();
+        for (const std::string& className : m_ClassNames)
+        {
+            std::vector<Method> methods;
+            AppendMethods(className, methods);
+            m_Classes->emplace(className, ObjectHolder::Own(Class(className, std::move(methods), nullptr)));
+        }
+    }
+    return *m_Classes;
+}
+
+void Extensions::AppendMethods(const std::string& className, std::vector<Method>& methods) const
+{
+    auto it = m_Methods.find(className);
+    if (it == m_Methods.end())
+        return;
+
+    // Methods of the script come first, so that it can override native ones
+    size_t defined = methods.size();
+    for (const NativeMethod& native : it->second)
+    {
+        auto end = methods.begin() + defined;
+        if (std::find_if(methods.begin(), end, [&native](const Method& method) { return method.name == native.name; }) != end)
+            continue;
+
+        Method& method = methods.emplace_back();
+        method.name = native.name;
+        method.formalParams = native.formalParams;
+        method.native = native.function;
+    }
+}
+
+}
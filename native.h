@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "object_holder.h"
+#include "context.h"
+
+namespace Runtime {
+
+class ClassInstance;
+struct Method;
+
+// Arguments of a native method, borrowed from the call for its duration.
+// The typed accessors throw the usual runtime errors on other types.
+class NativeArgs
+{
+public:
+    NativeArgs(const std::string& method, std::span<const ObjectHolder> args)
+        : m_Method(method), m_Args(args)
+    {
+    }
+
+    size_t Size() const
+    {
+        return m_Args.size();
+    }
+
+    const ObjectHolder& operator[](size_t index) const
+    {
+        return m_Args[index];
+    }
+
+    int GetNumber(size_t index) const;
+    std::string_view GetString(size_t index) const;
+    bool GetBool(size_t index) const;
+private:
+    const std::string& m_Method;
+    std::span<const ObjectHolder> m_Args;
+};
+
+// Body of a method written in C++. It's called like a method of the script
+// after the number of arguments has been checked, and may raise with
+// Context::SetRaise or throw runtime errors like the interpreter does.
+using NativeFunction = std::function<ObjectHolder(ClassInstance& self, const NativeArgs& args, Context& context)>;
+
+// Methods and classes written in C++ for the scripts. Register them before
+// parsing: the parser adds the methods to the classes of their names,
+// whether a script defines the class or it's one of the builtin classes,
+// which every script can use without defining them. A class of the script
+// with the name of a builtin class replaces it.
+class Extensions
+{
+public:
+    static Extensions& Get();
+
+    void AddMethod(const std::string& className, std::string name, std::vector<std::string> formalParams, NativeFunction function);
+    void AddClass(std::string name);
+
+    // The builtin classes, made on the first call and shared by every
+    // program and module parsed after it
+    const Closure& GetClasses();
+
+    // Appends the native methods of the class to the methods of its
+    // definition, except for the ones the definition has itself
+    void AppendMethods(const std::string& className, std::vector<Method>& methods) const;
+private:
+    struct NativeMethod
+    {
+        std::string name;
+        std::vector<std::string> formalParams;
+        NativeFunction function;
+    };
+
+    std::unordered_map<std::string, std::vector<NativeMethod>> m_Methods;
+    std::vector<std::string> m_ClassNames;
+    std::optional<Closure> m_Classes;
+};
+
+// Math: gcd(a, b), isqrt(n), parse(s), abs(n). An example of a builtin
+// class, registered by main for --math.
+void RegisterMath(Extensions& extensions);
+
+}
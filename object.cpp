@@ -1,20 +1,425 @@
 #include "object.h"
 #include "object_holder.h"
 #include "ast.h"
+#include "dict.h"
+#include "comparators.h"
+#include "string_kernels.h"
+#include <algorithm>
+#include <charconv>
+#include <functional>
 #include <sstream>
 
 namespace Runtime {
 
-void Bool::Print(std::ostream& os)
+namespace {
+
+// Slices of smaller buffers are cheap to keep even when they are short
+constexpr size_t LargeBufferBytes = 4096;
+
+}
+
+void PrintRepr(std::ostream& os, const ObjectHolder& object, Context& context)
+{
+    // A copy, printing may run user code that drops the last reference
+    ObjectHolder item = object;
+    if (!item)
+    {
+        os << "None";
+    }
+    else if (const String* str = item.TryAs<String>())
+    {
+        os << '\'' << str->GetValue() << '\'';
+    }
+    else
+    {
+        item->Print(os, context);
+    }
+}
+
+ObjectHolder MakeInteger(const BigInteger& value)
+{
+    if (std::optional<int> number = value.TryToInt())
+    {
+        return ObjectHolder::Own(Number(*number));
+    }
+    return ObjectHolder::Own(BigInt(value));
+}
+
+ObjectHolder DetachSlice(ObjectHolder value)
+{
+    if (const String* str = value.TryAs<String>(); str && str->PinsLargeBuffer())
+    {
+        return ObjectHolder::Own(String(std::string(str->GetValue())));
+    }
+    return value;
+}
+
+std::optional<BigInteger> ToBigInteger(const ObjectHolder& object)
+{
+    if (const Number* number = object.TryAs<Number>())
+    {
+        return BigInteger(number->GetValue());
+    }
+    else if (const BigInt* bigint = object.TryAs<BigInt>())
+    {
+        return bigint->GetValue();
+    }
+    return std::nullopt;
+}
+
+String::String(std::string value)
+    : Object(TypeTag::String), m_Buffer(std::make_shared<std::string>(std::move(value))), m_Offset(0)
+{
+    m_Size = m_Buffer->size();
+}
+
+String::String(std::shared_ptr<const std::string_view> external)
+    : Object(TypeTag::String), m_External(std::move(external)), m_Offset(0)
+{
+    m_Size = m_External->size();
+}
+
+String::String(const String& other, size_t offset, size_t size)
+    : Object(TypeTag::String), m_Buffer(other.m_Buffer), m_External(other.m_External), m_Offset(offset), m_Size(size)
+{
+}
+
+String String::Concat(const String& lhs, const String& rhs)
+{
+    if (lhs.m_Buffer && lhs.m_Offset + lhs.m_Size == lhs.m_Buffer->size())
+    {
+        if (lhs.m_Buffer == rhs.m_Buffer)
+        {
+            // Appending a part of the buffer to itself, it may reallocate
+            std::string copy(rhs.GetValue());
+            lhs.m_Buffer->append(copy);
+        }
+        else
+        {
+            lhs.m_Buffer->append(rhs.GetValue());
+        }
+        return String(lhs, lhs.m_Offset, lhs.m_Size + rhs.m_Size);
+    }
+
+    std::string result;
+    result.reserve(lhs.m_Size + rhs.m_Size);
+    result.append(lhs.GetValue()).append(rhs.GetValue());
+    return String(std::move(result));
+}
+
+String String::Repeat(const String& value, int count)
+{
+    std::string result;
+    if (count > 0)
+    {
+        result.reserve(value.m_Size * count);
+        for (int i = 0; i < count; i++)
+        {
+            result.append(value.GetValue());
+        }
+    }
+    return String(std::move(result));
+}
+
+String String::Slice(size_t begin, size_t end) const
+{
+    return String(*this, m_Offset + begin, end - begin);
+}
+
+ObjectHolder String::Get(int index) const
+{
+    // Negative indices count from the end
+    long long offset = index < 0 ? static_cast<long long>(m_Size) + index : index;
+
+    if (offset < 0 || offset >= static_cast<long long>(m_Size))
+    {
+        throw std::runtime_error("String index out of range");
+    }
+    return ObjectHolder::Own(Slice(offset, offset + 1));
+}
+
+bool String::PinsLargeBuffer() const
+{
+    size_t bufferSize = m_Buffer ? m_Buffer->capacity() : m_External->size();
+    return bufferSize >= LargeBufferBytes && m_Size * 4 < bufferSize;
+}
+
+size_t String::GetHash() const
+{
+    if (!m_HasHash)
+    {
+        m_Hash = std::hash<std::string_view>()(GetValue());
+        m_HasHash = true;
+    }
+    return m_Hash;
+}
+
+namespace {
+
+std::string_view StringArgument(const std::string& method, const ObjectHolder& arg)
+{
+    if (const String* str = arg.TryAs<String>())
+        return str->GetValue();
+
+    throw std::runtime_error("String method " + method + " takes strings");
+}
+
+bool IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+}
+
+ObjectHolder String::Call(const std::string& method, std::span<const ObjectHolder> actualParams) const
+{
+    std::string_view value = GetValue();
+    size_t count = actualParams.size();
+
+    if (method == "find" && (count == 1 || count == 2))
+    {
+        size_t start = 0;
+        if (count == 2)
+        {
+            const Number* number = actualParams[1].TryAs<Number>();
+            if (!number || number->GetValue() < 0)
+                throw std::runtime_error("find() start must be a non-negative int");
+            start = number->GetValue();
+        }
+
+        size_t position = Kernels::Find(value, StringArgument(method, actualParams[0]), start);
+        return ObjectHolder::Own(Number(position == Kernels::NotFound ? -1 : static_cast<int>(position)));
+    }
+
+    if (method == "count" && count == 1)
+    {
+        return ObjectHolder::Own(Number(static_cast<int>(Kernels::Count(value, StringArgument(method, actualParams[0])))));
+    }
+
+    if (method == "split" && count <= 1)
+    {
+        ObjectHolder result = ObjectHolder::Make<List>();
+        List& parts = static_cast<List&>(*result);
+
+        if (count == 0)
+        {
+            // Runs of whitespace separate the parts, and there are no empty ones
+            for (size_t i = 0; i < value.size(); )
+            {
+                while (i < value.size() && IsSpace(value[i]))
+                    i++;
+
+                size_t start = i;
+                while (i < value.size() && !IsSpace(value[i]))
+                    i++;
+
+                if (i > start)
+                    parts.Append(ObjectHolder::Own(Slice(start, i)));
+            }
+            return result;
+        }
+
+        std::string_view separator = StringArgument(method, actualParams[0]);
+        if (separator.empty())
+            throw std::runtime_error("split() separator must not be empty");
+
+        size_t start = 0;
+        for (size_t i = Kernels::Find(value, separator); i != Kernels::NotFound; i = Kernels::Find(value, separator, start))
+        {
+            parts.Append(ObjectHolder::Own(Slice(start, i)));
+            start = i + separator.size();
+        }
+        parts.Append(ObjectHolder::Own(Slice(start, value.size())));
+        return result;
+    }
+
+    if (method == "replace" && count == 2)
+    {
+        std::string_view from = StringArgument(method, actualParams[0]);
+        std::string_view to = StringArgument(method, actualParams[1]);
+
+        std::string result;
+        if (from.empty())
+        {
+            // Like Python, the replacement goes between all the characters
+            result.reserve(value.size() + (value.size() + 1) * to.size());
+            result.append(to);
+            for (char c : value)
+            {
+                result.push_back(c);
+                result.append(to);
+            }
+            return ObjectHolder::Own(String(std::move(result)));
+        }
+
+        size_t start = 0;
+        for (size_t i = Kernels::Find(value, from); i != Kernels::NotFound; i = Kernels::Find(value, from, start))
+        {
+            result.append(value.substr(start, i - start)).append(to);
+            start = i + from.size();
+        }
+
+        if (start == 0)
+            return ObjectHolder::Own(Slice(0, m_Size));
+
+        result.append(value.substr(start));
+        return ObjectHolder::Own(String(std::move(result)));
+    }
+
+    if (method == "startswith" && count == 1)
+    {
+        return ObjectHolder::Own(Bool(value.starts_with(StringArgument(method, actualParams[0]))));
+    }
+
+    if (method == "endswith" && count == 1)
+    {
+        return ObjectHolder::Own(Bool(value.ends_with(StringArgument(method, actualParams[0]))));
+    }
+
+    if ((method == "upper" || method == "lower") && count == 0)
+    {
+        std::string result(value.size(), '\0');
+        if (method == "upper")
+            Kernels::ToUpper(value.data(), result.data(), value.size());
+        else
+            Kernels::ToLower(value.data(), result.data(), value.size());
+        return ObjectHolder::Own(String(std::move(result)));
+    }
+
+    if (method == "strip" && count == 0)
+    {
+        size_t begin = 0;
+        size_t end = value.size();
+        while (begin < end && IsSpace(value[begin]))
+            begin++;
+        while (end > begin && IsSpace(value[end - 1]))
+            end--;
+        return ObjectHolder::Own(Slice(begin, end));
+    }
+
+    throw std::runtime_error("String has no method " + method + " taking " + std::to_string(count) + " arguments");
+}
+
+void String::Print(std::ostream& os, Context& context)
+{
+    os << GetValue();
+}
+
+void Bool::Print(std::ostream& os, Context& context)
 {
     os << (GetValue() ? "True" : "False");
 }
 
-void ClassInstance::Print(std::ostream& os)
+void Float::Print(std::ostream& os, Context& context)
+{
+    PrintFloat(os, GetValue());
+}
+
+namespace {
+
+// Room for the longest shortest representation of a double and ".0"
+constexpr size_t FloatChars = 32;
+
+std::string_view FormatFloat(char (&buffer)[FloatChars], double value)
+{
+    // Shortest digits that read back as the same value. Like Python, the
+    // fixed notation is used for decimal exponents from -4 up to 15.
+    std::to_chars_result result = std::to_chars(buffer, buffer + FloatChars, value, std::chars_format::scientific);
+    std::string_view text(buffer, result.ptr - buffer);
+
+    if (size_t e = text.find('e'); e != std::string_view::npos)
+    {
+        int exponent = 0;
+        std::from_chars(text.data() + e + 1 + (text[e + 1] == '+'), text.data() + text.size(), exponent);
+
+        if (exponent >= -4 && exponent < 16)
+        {
+            result = std::to_chars(buffer, buffer + FloatChars, value, std::chars_format::fixed);
+            text = std::string_view(buffer, result.ptr - buffer);
+        }
+    }
+
+    // Floats with integral values keep their point
+    if (text.find_first_of(".ein") == std::string_view::npos)
+    {
+        *result.ptr++ = '.';
+        *result.ptr++ = '0';
+    }
+    return std::string_view(buffer, result.ptr - buffer);
+}
+
+}
+
+void PrintFloat(std::ostream& os, double value)
+{
+    char buffer[FloatChars];
+    os << FormatFloat(buffer, value);
+}
+
+void AppendInt(std::string& out, int value)
+{
+    char buffer[16];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr - buffer);
+}
+
+void AppendFloat(std::string& out, double value)
+{
+    char buffer[FloatChars];
+    out.append(FormatFloat(buffer, value));
+}
+
+void AppendStr(std::string& out, const ObjectHolder& object, Context& context)
+{
+    switch (GetTypeTag(object))
+    {
+    case TypeTag::None:
+        out.append("None");
+        return;
+    case TypeTag::String:
+        out.append(static_cast<const String&>(*object).GetValue());
+        return;
+    case TypeTag::Number:
+        AppendInt(out, static_cast<const Number&>(*object).GetValue());
+        return;
+    case TypeTag::Float:
+        AppendFloat(out, static_cast<const Float&>(*object).GetValue());
+        return;
+    case TypeTag::Bool:
+        out.append(static_cast<const Bool&>(*object).GetValue() ? "True" : "False");
+        return;
+    case TypeTag::BigInt:
+        out.append(static_cast<const BigInt&>(*object).GetValue().ToString());
+        return;
+    default:
+        break;
+    }
+
+    // A copy, __str__ and printing may drop the last reference
+    ObjectHolder item = object;
+    if (ClassInstance* instance = item.TryAs<ClassInstance>(); instance && instance->HasMethod("__str__", 0))
+    {
+        AppendStr(out, instance->Call("__str__", {}, context), context);
+        return;
+    }
+
+    std::ostringstream os;
+    item->Print(os, context);
+    out.append(std::move(os).str());
+}
+
+void ClassInstance::Print(std::ostream& os, Context& context)
 {
     if (HasMethod("__str__", 0))
     {
-        Call("__str__", {})->Print(os);
+        if (ObjectHolder str = Call("__str__", {}, context))
+        {
+            str->Print(os, context);
+        }
+        else
+        {
+            os << "None";
+        }
     }
     else
     {
@@ -28,51 +433,133 @@ bool ClassInstance::HasMethod(const std::string& method, size_t argsCount) const
     return m && (m->formalParams).size() == argsCount;
 }
 
-ObjectHolder ClassInstance::Call(const std::string& method, const std::vector<ObjectHolder>& actualParams)
+namespace {
+
+// The key of the arguments of a call to a @memoize method or function,
+// nothing when the call isn't remembered. Methods lead the key with the id
+// of their instance, so that instances don't share results.
+std::optional<std::string> MemoKey(const Method& method, std::span<const ObjectHolder> actualParams, const uint64_t* receiver)
+{
+    if (!method.memo)
+        return std::nullopt;
+
+    std::string key;
+    if (receiver)
+        key.append(reinterpret_cast<const char*>(receiver), sizeof(*receiver));
+    if (!method.memo->MakeKey(actualParams, key))
+        return std::nullopt;
+    return key;
+}
+
+// The result of a call whose body has run. Raises aren't remembered, so
+// the next call with the same arguments raises again.
+ObjectHolder TakeResult(const Method& method, std::optional<std::string> key, Context& context)
+{
+    if (context.GetCompletion() == Completion::Raise)
+        return ObjectHolder::None();
+
+    ObjectHolder result = context.GetCompletion() == Completion::Return ? context.TakeReturnValue() : ObjectHolder::None();
+    if (key)
+        method.memo->Insert(std::move(*key), result);
+    return result;
+}
+
+}
+
+ObjectHolder ClassInstance::Call(const std::string& method, std::span<const ObjectHolder> actualParams, Context& context)
 {
     const Method* m = m_Class.GetMethod(method);
     if (!m)
     {
         throw std::runtime_error("Class " + m_Class.GetName() + " doesn't have method " + method);
     }
-    else if (m->formalParams.size() != actualParams.size())
+
+    // Called by name from inside of the runtime, which can't stop on a raise
+    // left in the context
+    ObjectHolder result = Call(*m, actualParams, context);
+    if (context.GetCompletion() == Completion::Raise)
+        throw Raised(context.TakeException());
+    return result;
+}
+
+ObjectHolder ClassInstance::Call(const Method& method, std::span<const ObjectHolder> actualParams, Context& context)
+{
+    if (method.formalParams.size() != actualParams.size())
     {
         std::ostringstream msg;
-        msg << "Method " << m_Class.GetName() << "::" << method << " requires " << m->formalParams.size()
+        msg << "Method " << m_Class.GetName() << "::" << method.name << " requires " << method.formalParams.size()
             << " parameters, but " << actualParams.size() << " given";
         throw std::runtime_error(msg.str());
     }
+    else if (method.native)
+    {
+        // The arguments are handed over as they are, without a closure
+        return method.native(*this, NativeArgs(method.name, actualParams), context);
+    }
     else
     {
-        try
+        std::optional<std::string> key = MemoKey(method, actualParams, &m_Id);
+        if (key)
         {
-            Closure closure = {{"self", ObjectHolder::Share(*this)}};
-            for (size_t i = 0; i < actualParams.size(); i++)
-            {
-                closure[m->formalParams[i]] = actualParams[i];
-            }
-            return m->body->Evaluate(closure);
+            if (const ObjectHolder* result = method.memo->Find(*key))
+                return *result;
         }
-        catch (ObjectHolder& returnedValue)
+
+        Closure closure = {{"self", GetSelf()}};
+        for (size_t i = 0; i < actualParams.size(); i++)
         {
-            return returnedValue;
+            closure[method.formalParams[i]] = actualParams[i];
         }
-        return ObjectHolder::None();
+
+        method.body->Evaluate(closure, context);
+        return TakeResult(method, std::move(key), context);
+    }
+}
+
+void ClassInstance::Traverse(const Visitor& visit) const
+{
+    for (const auto& [name, value] : m_Fields)
+    {
+        visit(value);
     }
 }
 
+void ClassInstance::Clear()
+{
+    Closure fields;
+    fields.swap(m_Fields);
+}
+
+ObjectHolder ClassInstance::GetSelf()
+{
+    // Owning when possible, so that self stored somewhere keeps the
+    // instance alive and is seen by the collector
+    if (std::shared_ptr<Collectable> owner = weak_from_this().lock())
+    {
+        return ObjectHolder(std::shared_ptr<Object>(owner, this));
+    }
+    return ObjectHolder::Share(*this);
+}
+
 Class::Class(std::string name, std::vector<Method> methods, const Class* parent)
     : m_Name(std::move(name)), m_Parent(parent)
 {
+    if (m_Parent)
+    {
+        m_VMT = m_Parent->m_VMT;
+    }
+
     for (auto& m : methods)
     {
-        if (m_VMT.find(m.name) != m_VMT.end())
+        if (m_Methods.find(m.name) != m_Methods.end())
         {
             throw std::runtime_error("Class " + m_Name + " has duplicate method " + m.name);
         }
         else
         {
-            m_VMT[m.name] = std::move(m);
+            std::string methodName = m.name;
+            Method& method = m_Methods[methodName] = std::move(m);
+            m_VMT[methodName] = &method;
         }
     }
 }
@@ -81,11 +568,7 @@ const Method* Class::GetMethod(const std::string& name) const
 {
     if (auto it = m_VMT.find(name); it != m_VMT.end())
     {
-        return &it->second;
-    }
-    else if (m_Parent)
-    {
-        return m_Parent->GetMethod(name);
+        return it->second;
     }
     else
     {
@@ -93,9 +576,263 @@ const Method* Class::GetMethod(const std::string& name) const
     }
 }
 
-void Class::Print(std::ostream& os)
+void Class::Print(std::ostream& os, Context& context)
 {
     os << "Class name " << m_Name;
 }
 
+Function::Function(std::string name)
+{
+    m_Method.name = std::move(name);
+}
+
+void Function::Define(std::vector<std::string> formalParams, std::unique_ptr<AST::Node> body, std::unique_ptr<Memo> memo)
+{
+    m_Method.formalParams = std::move(formalParams);
+    m_Method.body = std::move(body);
+    m_Method.memo = std::move(memo);
+}
+
+ObjectHolder Function::Call(std::span<const ObjectHolder> actualParams, Context& context) const
+{
+    if (m_Method.formalParams.size() != actualParams.size())
+    {
+        std::ostringstream msg;
+        msg << "Function " << m_Method.name << " requires " << m_Method.formalParams.size()
+            << " parameters, but " << actualParams.size() << " given";
+        throw std::runtime_error(msg.str());
+    }
+
+    std::optional<std::string> key = MemoKey(m_Method, actualParams, nullptr);
+    if (key)
+    {
+        if (const ObjectHolder* result = m_Method.memo->Find(*key))
+            return *result;
+    }
+
+    Closure closure;
+    for (size_t i = 0; i < actualParams.size(); i++)
+    {
+        closure[m_Method.formalParams[i]] = actualParams[i];
+    }
+
+    m_Method.body->Evaluate(closure, context);
+    return TakeResult(m_Method, std::move(key), context);
+}
+
+void Function::Print(std::ostream& os, Context& context)
+{
+    os << "Function " << m_Method.name;
+}
+
+size_t List::Size() const
+{
+    return std::visit([](const auto& items) { return items.size(); }, m_Items);
+}
+
+size_t List::ToOffset(int index) const
+{
+    size_t size = Size();
+    // Negative indices count from the end
+    long long offset = index < 0 ? static_cast<long long>(size) + index : index;
+
+    if (offset < 0 || offset >= static_cast<long long>(size))
+    {
+        throw std::runtime_error("List index out of range");
+    }
+    return static_cast<size_t>(offset);
+}
+
+ObjectHolder List::Get(int index) const
+{
+    size_t offset = ToOffset(index);
+    if (const auto* ints = std::get_if<std::vector<int>>(&m_Items))
+    {
+        return ObjectHolder::Own(Number((*ints)[offset]));
+    }
+    return std::get<std::vector<ObjectHolder>>(m_Items)[offset];
+}
+
+void List::Set(int index, ObjectHolder value)
+{
+    size_t offset = ToOffset(index);
+    if (auto* ints = std::get_if<std::vector<int>>(&m_Items))
+    {
+        if (const Number* number = value.TryAs<Number>())
+        {
+            (*ints)[offset] = number->GetValue();
+            return;
+        }
+    }
+    Generalize()[offset] = std::move(value);
+}
+
+void List::Append(ObjectHolder value)
+{
+    if (auto* ints = std::get_if<std::vector<int>>(&m_Items))
+    {
+        if (const Number* number = value.TryAs<Number>())
+        {
+            ints->push_back(number->GetValue());
+            return;
+        }
+    }
+    Generalize().push_back(std::move(value));
+}
+
+std::vector<ObjectHolder>& List::Generalize()
+{
+    if (auto* ints = std::get_if<std::vector<int>>(&m_Items))
+    {
+        std::vector<ObjectHolder> objects;
+        objects.reserve(ints->capacity());
+        for (int value : *ints)
+        {
+            objects.push_back(ObjectHolder::Own(Number(value)));
+        }
+        m_Items = std::move(objects);
+    }
+    return std::get<std::vector<ObjectHolder>>(m_Items);
+}
+
+ObjectHolder List::Call(const std::string& method, std::span<const ObjectHolder> actualParams)
+{
+    if (method == "append" && actualParams.size() == 1)
+    {
+        Append(DetachSlice(actualParams.front()));
+        return ObjectHolder::None();
+    }
+    throw std::runtime_error("List has no method " + method + " taking " + std::to_string(actualParams.size()) + " arguments");
+}
+
+void List::Print(std::ostream& os, Context& context)
+{
+    if (m_Printing)
+    {
+        os << "[...]";
+        return;
+    }
+
+    m_Printing = true;
+    os << '[';
+    for (size_t i = 0; i < Size(); i++)
+    {
+        if (i > 0)
+            os << ", ";
+
+        if (const auto* ints = std::get_if<std::vector<int>>(&m_Items))
+        {
+            os << (*ints)[i];
+        }
+        else
+        {
+            PrintRepr(os, std::get<std::vector<ObjectHolder>>(m_Items)[i], context);
+        }
+    }
+    os << ']';
+    m_Printing = false;
+}
+
+bool List::Contains(const ObjectHolder& value, Context& context) const
+{
+    if (const auto* ints = std::get_if<std::vector<int>>(&m_Items))
+    {
+        // Any number equal to an int matches it, like 1.0 and True match 1
+        std::optional<int> number = ToExactInt(value);
+        return number && std::find(ints->begin(), ints->end(), *number) != ints->end();
+    }
+
+    const auto& objects = std::get<std::vector<ObjectHolder>>(m_Items);
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        if (KeysEqual(objects[i], value, context))
+            return true;
+    }
+    return false;
+}
+
+void List::Traverse(const Visitor& visit) const
+{
+    if (const auto* objects = std::get_if<std::vector<ObjectHolder>>(&m_Items))
+    {
+        for (const ObjectHolder& item : *objects)
+        {
+            visit(item);
+        }
+    }
+}
+
+void List::Clear()
+{
+    std::vector<int> empty;
+    m_Items = std::move(empty);
+}
+
+Tuple::Tuple(std::span<ObjectHolder> items)
+    : Object(TypeTag::Tuple), m_Size(items.size())
+{
+    if (m_Size <= InlineCapacity)
+    {
+        std::move(items.begin(), items.end(), m_Inline.begin());
+    }
+    else
+    {
+        m_Heap.assign(std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()));
+    }
+}
+
+ObjectHolder Tuple::Get(int index) const
+{
+    // Negative indices count from the end
+    long long offset = index < 0 ? static_cast<long long>(m_Size) + index : index;
+
+    if (offset < 0 || offset >= static_cast<long long>(m_Size))
+    {
+        throw std::runtime_error("Tuple index out of range");
+    }
+    return GetItems()[offset];
+}
+
+bool Tuple::Contains(const ObjectHolder& value, Context& context) const
+{
+    for (const ObjectHolder& item : GetItems())
+    {
+        if (KeysEqual(item, value, context))
+            return true;
+    }
+    return false;
+}
+
+void Tuple::Print(std::ostream& os, Context& context)
+{
+    std::span<const ObjectHolder> items = GetItems();
+
+    os << '(';
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        if (i > 0)
+            os << ", ";
+        PrintRepr(os, items[i], context);
+    }
+    // A single element is told apart from a parenthesized expression
+    os << (items.size() == 1 ? ",)" : ")");
+}
+
+void Tuple::Traverse(const Visitor& visit) const
+{
+    for (const ObjectHolder& item : GetItems())
+    {
+        visit(item);
+    }
+}
+
+void Tuple::Clear()
+{
+    std::vector<ObjectHolder> heap;
+    heap.swap(m_Heap);
+    std::array<ObjectHolder, InlineCapacity> items;
+    items.swap(m_Inline);
+    m_Size = 0;
+}
+
 }
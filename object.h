@@ -1,10 +1,22 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <iostream>
+#include <span>
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
 #include "object_holder.h"
+#include "context.h"
+#include "collector.h"
+#include "bigint.h"
+#include "memo.h"
+#include "native.h"
 
 namespace AST {
     class Node;
@@ -12,23 +24,74 @@ namespace AST {
 
 namespace Runtime {
 
+// Runtime type of an object, so that operations can dispatch on the types
+// of their operands with a table lookup. None is the tag of empty holders.
+enum class TypeTag : uint8_t
+{
+    None,
+    Other,
+    Number,
+    BigInt,
+    Bool,
+    Float,
+    String,
+    Instance,
+    List,
+    Dict,
+    Array,
+    Tuple,
+    Count,
+};
+
 class Object
 {
 public:
+    Object(TypeTag tag = TypeTag::Other)
+        : m_Tag(tag)
+    {
+    }
+
     virtual ~Object() = default;
-    virtual void Print(std::ostream& os) = 0;
+    virtual void Print(std::ostream& os, Context& context) = 0;
+
+    TypeTag GetTypeTag() const
+    {
+        return m_Tag;
+    }
+private:
+    TypeTag m_Tag;
 };
 
+inline TypeTag GetTypeTag(const ObjectHolder& object)
+{
+    return object ? object->GetTypeTag() : TypeTag::None;
+}
+
+template <typename T>
+inline constexpr TypeTag ValueTypeTag = TypeTag::Other;
+
+template <>
+inline constexpr TypeTag ValueTypeTag<int> = TypeTag::Number;
+
+template <>
+inline constexpr TypeTag ValueTypeTag<BigInteger> = TypeTag::BigInt;
+
+template <>
+inline constexpr TypeTag ValueTypeTag<bool> = TypeTag::Bool;
+
+template <>
+inline constexpr TypeTag ValueTypeTag<double> = TypeTag::Float;
+
 template <typename T>
 class ValueObject : public Object
 {
 public:
     ValueObject(T value)
-        : m_Value(value)
+        : Object(ValueTypeTag<T>), m_Value(std::move(value))
     {
     }
 
-    void Print(std::ostream& os) override
+    void Print(std::ostream& os, Context& context) override
     {
         os << m_Value;
     }
@@ -42,20 +105,109 @@ private:
 };
 
 using Number = ValueObject<int>;
-using String = ValueObject<std::string>;
+using BigInt = ValueObject<BigInteger>;
+
+// Immutable string. Strings share a buffer which is only ever appended to,
+// and each of them sees its own range of it, so slicing doesn't copy.
+// Concatenation appends to the buffer in place when the left operand ends
+// where the buffer does, so building a string with s = s + x in a loop is
+// linear rather than quadratic. Views returned by GetValue are invalidated
+// by concatenation. External strings see memory owned by something else,
+// like a mapped file, and are never appended to.
+class String : public Object
+{
+public:
+    String(std::string value);
+    explicit String(std::shared_ptr<const std::string_view> external);
+
+    static String Concat(const String& lhs, const String& rhs);
+    static String Repeat(const String& value, int count);
+
+    std::string_view GetValue() const
+    {
+        const char* data = m_Buffer ? m_Buffer->data() : m_External->data();
+        return std::string_view(data + m_Offset, m_Size);
+    }
+
+    size_t Size() const
+    {
+        return m_Size;
+    }
+
+    // Characters from begin up to end, sharing the buffer
+    String Slice(size_t begin, size_t end) const;
+    // The character at the index as a string of length 1
+    ObjectHolder Get(int index) const;
+
+    // Whether the string is a small slice of a much larger buffer, which it
+    // keeps alive as long as it lives itself
+    bool PinsLargeBuffer() const;
+
+    // Computed on first use, so that strings used as dict keys over and
+    // over are only hashed once
+    size_t GetHash() const;
+
+    // Built-in methods: find(sub), find(sub, start), count(sub), split(),
+    // split(sep), replace(old, new), startswith(prefix), endswith(suffix),
+    // upper(), lower(), strip()
+    ObjectHolder Call(const std::string& method, std::span<const ObjectHolder> actualParams) const;
+
+    void Print(std::ostream& os, Context& context) override;
+private:
+    String(const String& other, size_t offset, size_t size);
+
+    std::shared_ptr<std::string> m_Buffer;
+    std::shared_ptr<const std::string_view> m_External;
+    size_t m_Offset;
+    size_t m_Size;
+    mutable size_t m_Hash = 0;
+    mutable bool m_HasHash = false;
+};
+
+// Prints the object the way it's shown inside of a container, with strings
+// in quotes
+void PrintRepr(std::ostream& os, const ObjectHolder& object, Context& context);
+
+// Containers and fields may keep their values for long, a small string
+// slice stored there is copied so that it doesn't keep its buffer alive
+ObjectHolder DetachSlice(ObjectHolder value);
+
+// Integers are Numbers while they fit into int and BigInts otherwise
+ObjectHolder MakeInteger(const BigInteger& value);
+std::optional<BigInteger> ToBigInteger(const ObjectHolder& object);
 
 class Bool : public ValueObject<bool>
 {
 public:
     using ValueObject<bool>::ValueObject;
-    void Print(std::ostream& os) override;
+    void Print(std::ostream& os, Context& context) override;
+};
+
+class Float : public ValueObject<double>
+{
+public:
+    using ValueObject<double>::ValueObject;
+    // Shortest representation that reads back as the same double
+    void Print(std::ostream& os, Context& context) override;
 };
 
+void PrintFloat(std::ostream& os, double value);
+
+// Append what str() of the value returns, without building a String or a
+// stream for it. Instances with __str__ append the string it returns.
+void AppendStr(std::string& out, const ObjectHolder& object, Context& context);
+void AppendInt(std::string& out, int value);
+void AppendFloat(std::string& out, double value);
+
 struct Method
 {
     std::string name;
     std::vector<std::string> formalParams;
     std::unique_ptr<AST::Node> body;
+    // Set for @memoize methods and functions
+    std::unique_ptr<Memo> memo;
+    // Set instead of the body for methods written in C++
+    NativeFunction native;
 };
 
 class Class : public Object
@@ -70,24 +222,68 @@ public:
         return m_Name;
     }
 
-    void Print(std::ostream& os) override;
+    const Class* GetParent() const
+    {
+        return m_Parent;
+    }
+
+    void Print(std::ostream& os, Context& context) override;
 private:
     std::string m_Name;
     const Class* m_Parent;
-    std::unordered_map<std::string, Method> m_VMT;
+    std::unordered_map<std::string, Method> m_Methods;
+    // Own and inherited methods resolved once on creation, so a lookup
+    // doesn't depend on the depth of the hierarchy
+    std::unordered_map<std::string, const Method*> m_VMT;
+};
+
+// Function defined at the top level of a module. The parser binds call
+// sites to the function object itself, so a call neither looks the name up
+// nor needs a receiver. Calls may precede the definition, the body is set
+// once it's parsed.
+class Function : public Object
+{
+public:
+    explicit Function(std::string name);
+
+    const std::string& GetName() const
+    {
+        return m_Method.name;
+    }
+
+    bool IsDefined() const
+    {
+        return m_Method.body != nullptr;
+    }
+
+    void Define(std::vector<std::string> formalParams, std::unique_ptr<AST::Node> body, std::unique_ptr<Memo> memo = nullptr);
+
+    ObjectHolder Call(std::span<const ObjectHolder> actualParams, Context& context) const;
+
+    void Print(std::ostream& os, Context& context) override;
+private:
+    Method m_Method;
 };
 
-class ClassInstance : public Object
+class ClassInstance : public Object, public Collectable
 {
 public:
     ClassInstance(const Class& cls)
-        : m_Class(cls)
+        : Object(TypeTag::Instance), m_Class(cls), m_Id(s_NextId++)
     {
     }
 
-    ObjectHolder Call(const std::string& method, const std::vector<ObjectHolder>& actualParams);
+    // Throws a raise of the method as Raised
+    ObjectHolder Call(const std::string& method, std::span<const ObjectHolder> actualParams, Context& context);
+    // Leaves a raise of the method in the context
+    ObjectHolder Call(const Method& method, std::span<const ObjectHolder> actualParams, Context& context);
     bool HasMethod(const std::string& method, size_t argsCount) const;
 
+    const Class& GetClass() const
+    {
+        return m_Class;
+    }
+
     Closure& GetFields()
     {
         return m_Fields;
@@ -98,10 +294,208 @@ public:
         return m_Fields;
     }
 
-    void Print(std::ostream& os) override;
+    void Print(std::ostream& os, Context& context) override;
+
+    void Traverse(const Visitor& visit) const override;
+    void Clear() override;
 private:
+    ObjectHolder GetSelf();
+
     const Class& m_Class;
     Closure m_Fields;
+    // Never reused, unlike addresses, so that memos can key results by it
+    uint64_t m_Id;
+
+    static inline uint64_t s_NextId = 0;
+};
+
+// List whose storage adapts to its contents. Lists of ints keep raw ints
+// contiguously, so they are only boxed when read, and switch to generic
+// holders the first time anything else is stored.
+class List : public Object, public Collectable
+{
+public:
+    List()
+        : Object(TypeTag::List)
+    {
+    }
+
+    size_t Size() const;
+
+    ObjectHolder Get(int index) const;
+    void Set(int index, ObjectHolder value);
+    void Append(ObjectHolder value);
+    bool Contains(const ObjectHolder& value, Context& context) const;
+
+    bool HasIntStorage() const
+    {
+        return std::holds_alternative<std::vector<int>>(m_Items);
+    }
+
+    // Raw elements while the list stores ints, nullptr otherwise
+    const std::vector<int>* TryGetInts() const
+    {
+        return std::get_if<std::vector<int>>(&m_Items);
+    }
+
+    // Built-in methods: append(value)
+    ObjectHolder Call(const std::string& method, std::span<const ObjectHolder> actualParams);
+
+    void Print(std::ostream& os, Context& context) override;
+
+    void Traverse(const Visitor& visit) const override;
+    void Clear() override;
+private:
+    size_t ToOffset(int index) const;
+    std::vector<ObjectHolder>& Generalize();
+
+    std::variant<std::vector<int>, std::vector<ObjectHolder>> m_Items;
+    bool m_Printing = false;
+};
+
+// Immutable sequence. Small tuples, like the multiple values returned from
+// a method, keep their elements inside the object itself, so that they take
+// a single pooled block.
+class Tuple : public Object, public Collectable
+{
+public:
+    static constexpr size_t InlineCapacity = 4;
+
+    // Moves the elements out of the span
+    explicit Tuple(std::span<ObjectHolder> items);
+
+    size_t Size() const
+    {
+        return m_Size;
+    }
+
+    std::span<const ObjectHolder> GetItems() const
+    {
+        return {m_Size <= InlineCapacity ? m_Inline.data() : m_Heap.data(), m_Size};
+    }
+
+    ObjectHolder Get(int index) const;
+    bool Contains(const ObjectHolder& value, Context& context) const;
+
+    void Print(std::ostream& os, Context& context) override;
+
+    void Traverse(const Visitor& visit) const override;
+    void Clear() override;
+private:
+    std::array<ObjectHolder, InlineCapacity> m_Inline;
+    std::vector<ObjectHolder> m_Heap;
+    size_t m_Size;
+};
+
+// C++ type of the objects with the tag
+template <TypeTag Tag>
+struct TaggedType
+{
+    using Type = Object;
+};
+
+template <>
+struct TaggedType<TypeTag::Number>
+{
+    using Type = Number;
+};
+
+template <>
+struct TaggedType<TypeTag::BigInt>
+{
+    using Type = BigInt;
+};
+
+template <>
+struct TaggedType<TypeTag::Bool>
+{
+    using Type = Bool;
+};
+
+template <>
+struct TaggedType<TypeTag::Float>
+{
+    using Type = Float;
+};
+
+template <>
+struct TaggedType<TypeTag::String>
+{
+    using Type = String;
+};
+
+template <>
+struct TaggedType<TypeTag::Instance>
+{
+    using Type = ClassInstance;
+};
+
+template <>
+struct TaggedType<TypeTag::List>
+{
+    using Type = List;
+};
+
+template <>
+struct PoolTraits<Number>
+{
+    static constexpr bool Pooled = true;
+    static constexpr const char* Name = "Number";
+    static constexpr size_t BlocksPerChunk = 1024;
+};
+
+template <>
+struct PoolTraits<Bool>
+{
+    static constexpr bool Pooled = true;
+    static constexpr const char* Name = "Bool";
+    static constexpr size_t BlocksPerChunk = 256;
+};
+
+template <>
+struct PoolTraits<Float>
+{
+    static constexpr bool Pooled = true;
+    static constexpr const char* Name = "Float";
+    static constexpr size_t BlocksPerChunk = 1024;
+};
+
+template <>
+struct PoolTraits<String>
+{
+    static constexpr bool Pooled = true;
+    static constexpr const char* Name = "String";
+    static constexpr size_t BlocksPerChunk = 512;
+};
+
+template <>
+struct PoolTraits<ClassInstance>
+{
+    static constexpr bool Pooled = true;
+    static constexpr const char* Name = "ClassInstance";
+    static constexpr size_t BlocksPerChunk = 256;
+};
+
+template <>
+struct TaggedType<TypeTag::Tuple>
+{
+    using Type = Tuple;
+};
+
+template <>
+struct PoolTraits<Tuple>
+{
+    static constexpr bool Pooled = true;
+    static constexpr const char* Name = "Tuple";
+    static constexpr size_t BlocksPerChunk = 1024;
+};
+
+template <>
+struct PoolTraits<List>
+{
+    static constexpr bool Pooled = true;
+    static constexpr const char* Name = "List";
+    static constexpr size_t BlocksPerChunk = 256;
 };
 
 }
@@ -1,23 +1,38 @@
 #include "object_holder.h"
 #include "object.h"
+#include "dict.h"
+#include "array.h"
+#include "context.h"
 
 namespace Runtime {
 
 std::ostream& operator<<(std::ostream& os, const Closure& closure)
 {
+    Context context;
     os << "Global scope" << '\n';
     for (auto it : closure)
     {
         os << it.first << ": ";
-        it.second->Print(os);
+        it.second->Print(os, context);
         os << '\n';
     }
     return os << '\n';
 }
 
+namespace {
+
+struct NoDelete
+{
+    void operator()(Object*) const
+    {
+    }
+};
+
+}
+
 ObjectHolder ObjectHolder::Share(Object& object)
 {
-    return ObjectHolder(std::shared_ptr<Object>(&object, [](Object*) { }));
+    return ObjectHolder(std::shared_ptr<Object>(&object, NoDelete()));
 }
 
 ObjectHolder ObjectHolder::None()
@@ -60,6 +75,11 @@ ObjectHolder::operator bool() const
     return Get();
 }
 
+bool ObjectHolder::IsOwning() const
+{
+    return m_Data && !std::get_deleter<NoDelete>(m_Data);
+}
+
 bool IsTrue(ObjectHolder object)
 {
     if (!object)
@@ -68,12 +88,30 @@ bool IsTrue(ObjectHolder object)
     if (auto p = object.TryAs<Number>(); p && p->GetValue() != 0)
         return true;
 
+    if (auto p = object.TryAs<BigInt>(); p && !p->GetValue().IsZero())
+        return true;
+
     if (auto p = object.TryAs<String>(); p && !p->GetValue().empty())
         return true;
 
     if (auto p = object.TryAs<Bool>(); p && p->GetValue())
         return true;
 
+    if (auto p = object.TryAs<Float>(); p && p->GetValue() != 0)
+        return true;
+
+    if (auto p = object.TryAs<List>(); p && p->Size() > 0)
+        return true;
+
+    if (auto p = object.TryAs<Dict>(); p && p->Size() > 0)
+        return true;
+
+    if (auto p = object.TryAs<Array>(); p && p->Size() > 0)
+        return true;
+
+    if (auto p = object.TryAs<Tuple>(); p && p->Size() > 0)
+        return true;
+
     return false;
 }
 
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <memory>
+#include <type_traits>
 #include <unordered_map>
+#include "pool.h"
 
 namespace Runtime {
 
@@ -14,9 +16,16 @@ public:
 
     template <typename T>
     static ObjectHolder Own(T&& object)
+    {
+        return Make<std::decay_t<T>>(std::forward<T>(object));
+    }
+
+    // Constructs the object right in its pooled heap block
+    template <typename T, typename ...Args>
+    static ObjectHolder Make(Args&& ...args)
     {
         return ObjectHolder(
-            std::make_shared<T>(std::forward<T>(object))
+            std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...)
         );
     }
 
@@ -45,7 +54,12 @@ public:
 
     explicit operator bool() const;
 
+    // False for the holders made by Share that don't keep the object alive
+    bool IsOwning() const;
+
 private:
+    friend class ClassInstance;
+
     ObjectHolder(std::shared_ptr<Object> data)
         : m_Data(data)
     {
@@ -0,0 +1,182 @@
+#include "output_sink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace Runtime {
+
+OutputSink::OutputSink(FlushPolicy policy)
+    : m_Policy(policy), m_Buffer(BufferBytes), m_Stream(this)
+{
+    setp(m_Buffer.data(), m_Buffer.data() + m_Buffer.size());
+}
+
+void OutputSink::Write(std::string_view text)
+{
+    if (text.size() <= static_cast<size_t>(epptr() - pptr()))
+    {
+        std::memcpy(pptr(), text.data(), text.size());
+        pbump(static_cast<int>(text.size()));
+        return;
+    }
+
+    if (m_Policy != FlushPolicy::OnExit && text.size() >= m_Buffer.size())
+    {
+        // Written out along with the buffer rather than copied into it
+        WriteOut(std::string_view(pbase(), pptr() - pbase()), text);
+        setp(m_Buffer.data(), m_Buffer.data() + m_Buffer.size());
+        return;
+    }
+
+    MakeRoom(text.size());
+    std::memcpy(pptr(), text.data(), text.size());
+    pbump(static_cast<int>(text.size()));
+}
+
+void OutputSink::WriteInt(int value)
+{
+    constexpr size_t MaxChars = 11;
+    if (static_cast<size_t>(epptr() - pptr()) < MaxChars)
+        MakeRoom(MaxChars);
+
+    std::to_chars_result result = std::to_chars(pptr(), epptr(), value);
+    pbump(static_cast<int>(result.ptr - pptr()));
+}
+
+void OutputSink::EndLine()
+{
+    if (pptr() == epptr())
+        MakeRoom(1);
+
+    *pptr() = '\n';
+    pbump(1);
+
+    if (m_Policy == FlushPolicy::Line)
+        Flush();
+}
+
+void OutputSink::Flush()
+{
+    if (pptr() != pbase())
+    {
+        WriteOut(std::string_view(pbase(), pptr() - pbase()), {});
+        setp(m_Buffer.data(), m_Buffer.data() + m_Buffer.size());
+    }
+}
+
+void OutputSink::MakeRoom(size_t n)
+{
+    if (m_Policy != FlushPolicy::OnExit)
+    {
+        Flush();
+        if (n <= m_Buffer.size())
+            return;
+    }
+
+    size_t used = pptr() - pbase();
+    if (used + n <= m_Buffer.size())
+        return;
+
+    m_Buffer.resize(std::max(m_Buffer.size() * 2, used + n));
+    setp(m_Buffer.data(), m_Buffer.data() + m_Buffer.size());
+    pbump(static_cast<int>(used));
+}
+
+OutputSink::int_type OutputSink::overflow(int_type c)
+{
+    MakeRoom(1);
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize OutputSink::xsputn(const char* s, std::streamsize n)
+{
+    Write(std::string_view(s, n));
+    return n;
+}
+
+int OutputSink::sync()
+{
+    Flush();
+    return 0;
+}
+
+FdSink::FdSink(int fd)
+    : OutputSink(isatty(fd) ? FlushPolicy::Line : FlushPolicy::Block), m_Fd(fd)
+{
+}
+
+FdSink::~FdSink()
+{
+    try
+    {
+        Flush();
+    }
+    catch (const std::exception&)
+    {
+        // Nowhere left to report it
+    }
+}
+
+void FdSink::WriteOut(std::string_view buffered, std::string_view rest)
+{
+    iovec parts[2] = {
+        {const_cast<char*>(buffered.data()), buffered.size()},
+        {const_cast<char*>(rest.data()), rest.size()},
+    };
+    iovec* part = parts;
+    int count = 2;
+
+    while (count > 0)
+    {
+        ssize_t written = writev(m_Fd, part, count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            throw std::runtime_error(std::string("Cannot write the output: ") + std::strerror(errno));
+        }
+
+        // Skips what was written, writes may be partial on pipes
+        size_t left = static_cast<size_t>(written);
+        while (count > 0 && left >= part->iov_len)
+        {
+            left -= part->iov_len;
+            part++;
+            count--;
+        }
+        if (count > 0)
+        {
+            part->iov_base = static_cast<char*>(part->iov_base) + left;
+            part->iov_len -= left;
+        }
+    }
+}
+
+StreamSink::StreamSink(std::ostream& os, FlushPolicy policy)
+    : OutputSink(policy), m_Output(os)
+{
+}
+
+StreamSink::~StreamSink()
+{
+    Flush();
+}
+
+void StreamSink::WriteOut(std::string_view buffered, std::string_view rest)
+{
+    m_Output.write(buffered.data(), buffered.size());
+    m_Output.write(rest.data(), rest.size());
+    m_Output.flush();
+}
+
+}
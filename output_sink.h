@@ -0,0 +1,94 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string_view>
+#include <vector>
+
+namespace Runtime {
+
+enum class FlushPolicy
+{
+    // After every printed line, for terminals
+    Line,
+    // Whenever the buffer fills up
+    Block,
+    // Only at the end of the program, the buffer grows to hold everything
+    OnExit,
+};
+
+// Destination of print. The text is collected in a large buffer which is
+// handed to the backend as a whole, and the buffer is the put area of the
+// stream objects print to, so stream output doesn't go through a virtual
+// call per character either.
+class OutputSink : private std::streambuf
+{
+public:
+    static constexpr size_t BufferBytes = 64 * 1024;
+
+    explicit OutputSink(FlushPolicy policy);
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+    // Backends flush in their own destructors, while they still exist
+    virtual ~OutputSink() = default;
+
+    void Write(std::string_view text);
+    void WriteInt(int value);
+    void EndLine();
+    void Flush();
+
+    // Writes into the buffer of the sink
+    std::ostream& GetStream()
+    {
+        return m_Stream;
+    }
+
+    void SetFlushPolicy(FlushPolicy policy)
+    {
+        m_Policy = policy;
+    }
+protected:
+    // Writes out the buffered text followed by the text that didn't fit
+    // into the buffer, either of them may be empty
+    virtual void WriteOut(std::string_view buffered, std::string_view rest) = 0;
+private:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override;
+
+    // Room for n more characters, by flushing or growing the buffer
+    void MakeRoom(size_t n);
+
+    FlushPolicy m_Policy;
+    std::vector<char> m_Buffer;
+    std::ostream m_Stream;
+};
+
+// Writes to a file descriptor with write(2), and with writev(2) when text
+// bigger than the buffer follows what's buffered
+class FdSink : public OutputSink
+{
+public:
+    // Lines are flushed on terminals and blocks elsewhere
+    explicit FdSink(int fd);
+    ~FdSink() override;
+protected:
+    void WriteOut(std::string_view buffered, std::string_view rest) override;
+private:
+    int m_Fd;
+};
+
+// Writes to a stream, for embedding and capturing the output
+class StreamSink : public OutputSink
+{
+public:
+    explicit StreamSink(std::ostream& os, FlushPolicy policy = FlushPolicy::Line);
+    ~StreamSink() override;
+protected:
+    void WriteOut(std::string_view buffered, std::string_view rest) override;
+private:
+    std::ostream& m_Output;
+};
+
+}
@@ -1,13 +1,34 @@
 #include "parser.h"
 #include "comparators.h"
+#include "allocation_counter.h"
+#include "module.h"
+#include <iostream>
+#include <sstream>
 
 std::unique_ptr<AST::Node> Parser::ParseProgram()
 {
+    AllocationCounter::Scope scope(AllocationCounter::Phase::Parse);
+
     std::unique_ptr<AST::Compound> statements = std::make_unique<AST::Compound>();
+
+    // Builtin classes are defined ahead of the program as if it began with them
+    for (const auto& [className, cls] : Runtime::Extensions::Get().GetClasses())
+    {
+        m_DeclaredClasses.insert({className, cls});
+        m_BuiltinClasses.insert(className);
+        statements->Add(std::make_unique<AST::ClassDefinition>(cls));
+    }
+
     while (!m_CurrentToken.Is<Tokens::Eof>())
     {
         statements->Add(ParseStatement());
     }
+
+    for (const auto& [name, function] : m_DeclaredFunctions)
+    {
+        if (!static_cast<const Runtime::Function&>(*function).IsDefined())
+            throw std::runtime_error("Function " + name + " is called but never defined");
+    }
     return statements;
 }
 
@@ -15,13 +36,32 @@ std::unique_ptr<AST::Node> Parser::ParseStatement()
 {
     if (m_CurrentToken.Is<Tokens::Class>())
     {
-        Consume<Tokens::Class>();
         return ParseClassDefinition();
     }
+    else if (m_CurrentToken.Is<Tokens::Def>())
+    {
+        return ParseFunctionDefinition(std::nullopt);
+    }
+    else if (m_CurrentToken.Is<Tokens::At>())
+    {
+        return ParseFunctionDefinition(ParseMemoize());
+    }
     else if (m_CurrentToken.Is<Tokens::If>())
     {
         return ParseCondition();
     }
+    else if (m_CurrentToken.Is<Tokens::While>())
+    {
+        return ParseWhile();
+    }
+    else if (m_CurrentToken.Is<Tokens::For>())
+    {
+        return ParseFor();
+    }
+    else if (m_CurrentToken.Is<Tokens::Try>())
+    {
+        return ParseTry();
+    }
     std::unique_ptr<AST::Node> statement = ParseSimpleStatement();
     Consume<Tokens::NewLine>();
     return statement;
@@ -30,20 +70,15 @@ std::unique_ptr<AST::Node> Parser::ParseStatement()
 std::unique_ptr<AST::Node> Parser::ParseClassDefinition()
 {
     Consume<Tokens::Class>();
-    Token classToken = m_CurrentToken;
-    Consume<Tokens::Id>();
-    std::string className = classToken.As<Tokens::Id>().value;
+    std::string className = Consume<Tokens::Id>().value;
 
     const Runtime::Class* baseClass = nullptr;
     if (m_CurrentToken.Is<Tokens::Lparen>())
     {
         Consume<Tokens::Lparen>();
-        Token baseClassToken = m_CurrentToken;
-        Consume<Tokens::Id>();
+        std::string baseClassName = Consume<Tokens::Id>().value;
         Consume<Tokens::Rparen>();
 
-        std::string baseClassName = baseClassToken.As<Tokens::Id>().value;
-
         if (auto it = m_DeclaredClasses.find(baseClassName); it == m_DeclaredClasses.end())
         {
             throw std::runtime_error("Base class " + baseClassName + " not found for class " + className);
@@ -57,52 +92,220 @@ std::unique_ptr<AST::Node> Parser::ParseClassDefinition()
     Consume<Tokens::Colon>();
     Consume<Tokens::NewLine>();
     Consume<Tokens::Indent>();
-    std::vector<Runtime::Method> methods = ParseMethods();
+    std::vector<Runtime::Method> methods = ParseMethods(className);
+    Runtime::Extensions::Get().AppendMethods(className, methods);
     Consume<Tokens::Dedent>();
 
-    auto [it, inserted] = m_DeclaredClasses.insert({
-        className,
-        ObjectHolder::Own(
-            Runtime::Class(className, std::move(methods), baseClass)
-        )
-    });
-
-    if (!inserted)
+    auto [it, inserted] = m_DeclaredClasses.insert({className, ObjectHolder()});
+    if (!inserted && !m_BuiltinClasses.erase(className))
         throw std::runtime_error("Class " + className + " already exists");
 
+    it->second = ObjectHolder::Own(Runtime::Class(className, std::move(methods), baseClass));
+
+    m_DefinedClasses[className] = it->second;
     return std::make_unique<AST::ClassDefinition>(it->second);
 }
 
-std::vector<Runtime::Method> Parser::ParseMethods()
+std::vector<Runtime::Method> Parser::ParseMethods(const std::string& className)
 {
     std::vector<Runtime::Method> methods;
 
-    while (m_CurrentToken.Is<Tokens::Def>())
+    while (m_CurrentToken.Is<Tokens::Def>() || m_CurrentToken.Is<Tokens::At>())
     {
+        std::optional<size_t> memoCapacity;
+        if (m_CurrentToken.Is<Tokens::At>())
+            memoCapacity = ParseMemoize();
+
         Runtime::Method method;
         Consume<Tokens::Def>();
-        Token methodNameToken = m_CurrentToken;
-        Consume<Tokens::Id>();
-        method.name = methodNameToken.As<Tokens::Id>().value;
-        Consume<Tokens::Lparen>();
+        method.name = Consume<Tokens::Id>().value;
+        method.formalParams = ParseFormalParams();
 
-        if (m_CurrentToken.Is<Tokens::Id>())
+        if (memoCapacity)
         {
-            do
-            {
-                Token paramToken = m_CurrentToken;
-                Consume<Tokens::Id>();
-                method.formalParams.push_back(paramToken.As<Tokens::Id>().value);
-            } while (m_CurrentToken.Is<Tokens::Comma>());
+            std::string name = className + "." + method.name;
+            method.body = ParseMemoizedBody(name);
+            method.memo = std::make_unique<Runtime::Memo>(std::move(name), *memoCapacity);
+        }
+        else
+        {
+            method.body = ParseCallableBody();
         }
+        methods.push_back(std::move(method));
+    }
+    return methods;
+}
+
+size_t Parser::ParseMemoize()
+{
+    Consume<Tokens::At>();
+    std::string decorator = Consume<Tokens::Id>().value;
+    if (decorator != "memoize")
+        throw std::runtime_error("Unknown decorator @" + decorator);
+
+    // Results remembered unless a capacity is given
+    size_t capacity = 1024;
+    if (m_CurrentToken.Is<Tokens::Lparen>())
+    {
+        Consume<Tokens::Lparen>();
+        int value = Consume<Tokens::Integer>().value;
+        if (value <= 0)
+            throw std::runtime_error("@memoize capacity must be positive");
 
+        capacity = static_cast<size_t>(value);
         Consume<Tokens::Rparen>();
-        Consume<Tokens::Colon>();
+    }
 
-        method.body = ParseBlock();
-        methods.push_back(std::move(method));
+    Consume<Tokens::NewLine>();
+    return capacity;
+}
+
+std::unique_ptr<AST::Node> Parser::ParseMemoizedBody(const std::string& name)
+{
+    std::optional<Impurities> outer = std::exchange(m_Impurities, Impurities());
+    std::unique_ptr<AST::Node> body = ParseCallableBody();
+    Impurities impurities = *std::exchange(m_Impurities, std::move(outer));
+
+    // A remembered generator would be shared by the calls, half consumed
+    if (dynamic_cast<AST::GeneratorBody*>(body.get()))
+        throw std::runtime_error("@memoize " + name + " can't yield");
+
+    for (const std::string& use : impurities.selfUses)
+    {
+        std::cerr << "Warning: @memoize " << name << " uses " << use
+                  << ", its remembered results don't follow changes of the instance" << '\n';
     }
-    return methods;
+    if (impurities.prints)
+    {
+        std::cerr << "Warning: @memoize " << name << " prints, which is skipped when a result is remembered" << '\n';
+    }
+    return body;
+}
+
+std::unique_ptr<AST::Node> Parser::ParseFunctionDefinition(std::optional<size_t> memoCapacity)
+{
+    if (m_BlockDepth > 0)
+        throw std::runtime_error("Functions can only be defined at the top level");
+
+    Consume<Tokens::Def>();
+    std::string name = Consume<Tokens::Id>().value;
+
+    // Declared before the body is parsed, so that it can call itself
+    ObjectHolder function = DeclareFunction(name);
+    Runtime::Function& definition = static_cast<Runtime::Function&>(*function);
+    if (definition.IsDefined())
+        throw std::runtime_error("Function " + name + " is already defined");
+
+    std::vector<std::string> formalParams = ParseFormalParams();
+    if (memoCapacity)
+    {
+        std::unique_ptr<AST::Node> body = ParseMemoizedBody(name);
+        definition.Define(std::move(formalParams), std::move(body), std::make_unique<Runtime::Memo>(name, *memoCapacity));
+    }
+    else
+    {
+        definition.Define(std::move(formalParams), ParseCallableBody());
+    }
+    m_DefinedFunctions[name] = function;
+    return std::make_unique<AST::FunctionDefinition>(std::move(function));
+}
+
+std::vector<std::string> Parser::ParseFormalParams()
+{
+    std::vector<std::string> formalParams;
+    Consume<Tokens::Lparen>();
+
+    if (m_CurrentToken.Is<Tokens::Id>())
+    {
+        while (true)
+        {
+            formalParams.push_back(Consume<Tokens::Id>().value);
+
+            if (!m_CurrentToken.Is<Tokens::Comma>())
+                break;
+
+            Consume<Tokens::Comma>();
+        }
+    }
+
+    Consume<Tokens::Rparen>();
+    return formalParams;
+}
+
+std::unique_ptr<AST::Node> Parser::ParseCallableBody()
+{
+    Consume<Tokens::Colon>();
+
+    // Loops around a definition don't extend into its body
+    int loopDepth = std::exchange(m_LoopDepth, 0);
+    bool inCallable = std::exchange(m_InCallable, true);
+    bool hasYield = std::exchange(m_HasYield, false);
+    std::unique_ptr<AST::Node> body = ParseBlock();
+
+    // A body with a yield anywhere in it makes a generator when called
+    if (m_HasYield)
+        body = std::make_unique<AST::GeneratorBody>(std::move(body));
+
+    m_LoopDepth = loopDepth;
+    m_InCallable = inCallable;
+    m_HasYield = hasYield;
+    return body;
+}
+
+ObjectHolder Parser::DeclareFunction(const std::string& name)
+{
+    ObjectHolder& function = m_DeclaredFunctions[name];
+    if (!function)
+        function = ObjectHolder::Make<Runtime::Function>(name);
+    return function;
+}
+
+// Calls of a bare name: classes, functions and builtins, resolved here once
+// rather than on every evaluation
+std::unique_ptr<AST::Node> Parser::MakeCall(std::string name, std::vector<std::unique_ptr<AST::Node>> args)
+{
+    if (auto it = m_DeclaredClasses.find(name); it != m_DeclaredClasses.end())
+    {
+        return std::make_unique<AST::NewInstance>(
+            static_cast<const Runtime::Class&>(*it->second),
+            std::move(args)
+        );
+    }
+
+    bool builtin = name == "str" || name == "len" || name == "array" || name == "open";
+    if (!builtin || m_DeclaredFunctions.contains(name))
+    {
+        ObjectHolder function = DeclareFunction(name);
+        return std::make_unique<AST::FunctionCall>(static_cast<const Runtime::Function&>(*function), std::move(args));
+    }
+
+    if (name == "str")
+    {
+        if (args.size() != 1)
+            throw std::runtime_error("Function str takes exactly one argument");
+
+        return std::make_unique<AST::Stringify>(std::move(args.front()));
+    }
+    else if (name == "len")
+    {
+        if (args.size() != 1)
+            throw std::runtime_error("Function len takes exactly one argument");
+
+        return std::make_unique<AST::Length>(std::move(args.front()));
+    }
+    else if (name == "open")
+    {
+        if (args.size() != 1)
+            throw std::runtime_error("Function open takes exactly one argument");
+
+        return std::make_unique<AST::OpenFile>(std::move(args.front()));
+    }
+
+    if (args.empty() || args.size() > 2)
+        throw std::runtime_error("Function array takes one or two arguments");
+
+    std::unique_ptr<AST::Node> elementType = args.size() == 2 ? std::move(args.back()) : nullptr;
+    return std::make_unique<AST::MakeArray>(std::move(args.front()), std::move(elementType));
 }
 
 std::unique_ptr<AST::Node> Parser::ParseCondition()
@@ -113,7 +316,7 @@ std::unique_ptr<AST::Node> Parser::ParseCondition()
     Consume<Tokens::Colon>();
     std::unique_ptr<AST::Node> ifBody = ParseBlock();
 
-    std::unique_ptr<AST::Node> elseBody = ParseBlock();
+    std::unique_ptr<AST::Node> elseBody;
     if (m_CurrentToken.Is<Tokens::Else>())
     {
         Consume<Tokens::Else>();
@@ -124,6 +327,133 @@ std::unique_ptr<AST::Node> Parser::ParseCondition()
     return std::make_unique<AST::IfElse>(std::move(condition), std::move(ifBody), std::move(elseBody));
 }
 
+std::unique_ptr<AST::Node> Parser::ParseTry()
+{
+    Consume<Tokens::Try>();
+    Consume<Tokens::Colon>();
+    std::unique_ptr<AST::Node> body = ParseBlock();
+
+    std::vector<AST::TryExcept::Handler> handlers;
+    do
+    {
+        Consume<Tokens::Except>();
+        AST::TryExcept::Handler& handler = handlers.emplace_back();
+
+        if (m_CurrentToken.Is<Tokens::Id>())
+        {
+            std::string className = Consume<Tokens::Id>().value;
+            if (auto it = m_DeclaredClasses.find(className); it == m_DeclaredClasses.end())
+            {
+                throw std::runtime_error("Class " + className + " not found for except");
+            }
+            else
+            {
+                handler.cls = static_cast<const Runtime::Class*>(it->second.Get());
+            }
+        }
+
+        if (m_CurrentToken.Is<Tokens::As>())
+        {
+            Consume<Tokens::As>();
+            handler.varName = Consume<Tokens::Id>().value;
+        }
+
+        Consume<Tokens::Colon>();
+        handler.body = ParseBlock();
+    } while (m_CurrentToken.Is<Tokens::Except>());
+
+    return std::make_unique<AST::TryExcept>(std::move(body), std::move(handlers));
+}
+
+// The module is loaded right away, so that its classes and functions resolve
+// like the program's own. Modules imported twice, here or by other modules,
+// bring the same objects.
+std::unique_ptr<AST::Node> Parser::ParseImport()
+{
+    if (m_BlockDepth > 0)
+        throw std::runtime_error("Modules can only be imported at the top level");
+
+    Consume<Tokens::Import>();
+    const Module& module = Modules::Get().Import(Consume<Tokens::Id>().value);
+
+    std::unique_ptr<AST::Compound> definitions = std::make_unique<AST::Compound>();
+    for (const auto& [name, cls] : module.classes)
+    {
+        auto [it, inserted] = m_DeclaredClasses.insert({name, cls});
+        if (!inserted && it->second.Get() != cls.Get())
+        {
+            if (!m_BuiltinClasses.erase(name))
+                throw std::runtime_error("Class " + name + " of module " + module.name + " already exists");
+            it->second = cls;
+        }
+
+        definitions->Add(std::make_unique<AST::ClassDefinition>(cls));
+    }
+
+    for (const auto& [name, function] : module.functions)
+    {
+        auto [it, inserted] = m_DeclaredFunctions.insert({name, function});
+        if (!inserted && it->second.Get() != function.Get())
+            throw std::runtime_error("Function " + name + " of module " + module.name + " already exists");
+
+        definitions->Add(std::make_unique<AST::FunctionDefinition>(function));
+    }
+    return definitions;
+}
+
+std::unique_ptr<AST::Node> Parser::ParseWhile()
+{
+    Consume<Tokens::While>();
+    std::unique_ptr<AST::Node> condition = ParseLogicalExpr();
+
+    Consume<Tokens::Colon>();
+    return std::make_unique<AST::While>(std::move(condition), ParseLoopBody());
+}
+
+std::unique_ptr<AST::Node> Parser::ParseFor()
+{
+    Consume<Tokens::For>();
+    std::string varName = Consume<Tokens::Id>().value;
+    Consume<Tokens::In>();
+
+    // range(...) right in the loop header is a counted loop
+    if (m_CurrentToken.Is<Tokens::Id>() && m_CurrentToken.As<Tokens::Id>().value == "range")
+    {
+        Consume<Tokens::Id>();
+        Consume<Tokens::Lparen>();
+        std::vector<std::unique_ptr<AST::Node>> args = ParseLogicalExprList();
+        Consume<Tokens::Rparen>();
+        Consume<Tokens::Colon>();
+
+        if (args.size() > 3)
+            throw std::runtime_error("range() takes one to three arguments");
+
+        std::unique_ptr<AST::Node> start;
+        std::unique_ptr<AST::Node> step;
+        if (args.size() > 1)
+            start = std::move(args.front());
+        if (args.size() == 3)
+            step = std::move(args.back());
+
+        std::unique_ptr<AST::Node> stop = std::move(args[args.size() == 1 ? 0 : 1]);
+        return std::make_unique<AST::ForRange>(
+            std::move(varName), std::move(start), std::move(stop), std::move(step), ParseLoopBody()
+        );
+    }
+
+    std::unique_ptr<AST::Node> container = ParseLogicalExpr();
+    Consume<Tokens::Colon>();
+    return std::make_unique<AST::ForEach>(std::move(varName), std::move(container), ParseLoopBody());
+}
+
+std::unique_ptr<AST::Node> Parser::ParseLoopBody()
+{
+    m_LoopDepth++;
+    std::unique_ptr<AST::Node> body = ParseBlock();
+    m_LoopDepth--;
+    return body;
+}
+
 std::unique_ptr<AST::Node> Parser::ParseBlock()
 {
     Consume<Tokens::NewLine>();
@@ -131,10 +461,12 @@ std::unique_ptr<AST::Node> Parser::ParseBlock()
 
     std::unique_ptr<AST::Compound> block = std::make_unique<AST::Compound>();
 
+    m_BlockDepth++;
     while (!m_CurrentToken.Is<Tokens::Dedent>())
     {
         block->Add(ParseStatement());
     }
+    m_BlockDepth--;
 
     Consume<Tokens::Dedent>();
     return block;
@@ -145,7 +477,25 @@ std::unique_ptr<AST::Node> Parser::ParseSimpleStatement()
     if (m_CurrentToken.Is<Tokens::Return>())
     {
         Consume<Tokens::Return>();
-        return std::make_unique<AST::Return>(ParseLogicalExpr());
+        return std::make_unique<AST::Return>(ParseTupleOrLogicalExpr());
+    }
+    else if (m_CurrentToken.Is<Tokens::Raise>())
+    {
+        Consume<Tokens::Raise>();
+        return std::make_unique<AST::Raise>(ParseTupleOrLogicalExpr());
+    }
+    else if (m_CurrentToken.Is<Tokens::Import>())
+    {
+        return ParseImport();
+    }
+    else if (m_CurrentToken.Is<Tokens::Yield>())
+    {
+        if (!m_InCallable)
+            throw std::runtime_error("yield is only allowed in methods and functions");
+
+        Consume<Tokens::Yield>();
+        m_HasYield = true;
+        return std::make_unique<AST::Yield>(ParseTupleOrLogicalExpr());
     }
     else if (m_CurrentToken.Is<Tokens::Print>())
     {
@@ -159,68 +509,106 @@ std::unique_ptr<AST::Node> Parser::ParseSimpleStatement()
         }
 
         Consume<Tokens::Rparen>();
+        if (m_Impurities)
+            m_Impurities->prints = true;
         return std::make_unique<AST::Print>(std::move(args));
     }
+    else if (m_CurrentToken.Is<Tokens::Break>() || m_CurrentToken.Is<Tokens::Continue>())
+    {
+        if (m_LoopDepth == 0)
+            throw std::runtime_error("break and continue are only allowed in loops");
+
+        if (m_CurrentToken.Is<Tokens::Break>())
+        {
+            Consume<Tokens::Break>();
+            return std::make_unique<AST::Break>();
+        }
+        Consume<Tokens::Continue>();
+        return std::make_unique<AST::Continue>();
+    }
     return ParseAssignmentStatementOrCall();
 }
 
 std::unique_ptr<AST::Node> Parser::ParseAssignmentStatementOrCall()
 {
     std::vector<std::string> idList = ParseDottedIds();
-    std::string varName = idList.back();
-    idList.pop_back();
+
+    if (m_CurrentToken.Is<Tokens::Comma>() && idList.size() == 1)
+    {
+        // a, b = value
+        std::vector<std::string> varNames = std::move(idList);
+        while (m_CurrentToken.Is<Tokens::Comma>())
+        {
+            Consume<Tokens::Comma>();
+            varNames.push_back(Consume<Tokens::Id>().value);
+        }
+
+        Consume<Tokens::Assign>();
+        return std::make_unique<AST::UnpackAssign>(std::move(varNames), ParseTupleOrLogicalExpr());
+    }
 
     if (m_CurrentToken.Is<Tokens::Assign>())
     {
         Consume<Tokens::Assign>();
+        std::string varName = std::move(idList.back());
+        idList.pop_back();
+
         if (idList.empty())
         {
-            return std::make_unique<AST::Assign>(std::move(varName), ParseExpr());
+            return std::make_unique<AST::Assign>(std::move(varName), ParseTupleOrLogicalExpr());
         }
         else
         {
             return std::make_unique<AST::FieldAssign>(
                 std::make_unique<AST::VariableValue>(std::move(idList)),
                 std::move(varName),
-                ParseExpr()
+                ParseLogicalExpr()
             );
         }
     }
-    else
-    {
-        Consume<Tokens::Lparen>();
-
-        if (idList.empty())
-        {
-            throw std::runtime_error("The language doesn't support functions");
-        }
-
-        std::vector<std::unique_ptr<AST::Node>> args;
-        if (!m_CurrentToken.Is<Tokens::Rparen>())
-        {
-            args = ParseLogicalExprList();
-        }
 
-        Consume<Tokens::Rparen>();
+    // A call, or a chain of subscripts, fields and calls like d["a"].append(2)
+    // that ends in a call or is assigned to, like xs[0].name = value
+    bool isCall = m_CurrentToken.Is<Tokens::Lparen>();
+    std::unique_ptr<AST::Node> node = ParseNameOrCall(std::move(idList));
+    if (m_CurrentToken.Is<Tokens::Lbracket>() || m_CurrentToken.Is<Tokens::Dot>())
+    {
+        node = ParsePostfix(std::move(node));
+        isCall = dynamic_cast<AST::MethodCall*>(node.get()) != nullptr;
+    }
 
-        return std::make_unique<AST::MethodCall>(
-            std::make_unique<AST::VariableValue>(std::move(idList)),
-            std::move(varName),
-            std::move(args)
-        );
+    if (m_CurrentToken.Is<Tokens::Assign>())
+    {
+        Consume<Tokens::Assign>();
+        std::unique_ptr<AST::Node> assign = node->MakeAssign(ParseLogicalExpr());
+        if (!assign)
+            throw std::runtime_error("Only variables, fields and subscripts can be assigned to");
+        return assign;
     }
+
+    if (!isCall)
+        throw std::runtime_error("A statement must be a call or an assignment");
+    return node;
 }
 
 std::vector<std::string> Parser::ParseDottedIds()
 {
-    std::vector<std::string> result(1, m_CurrentToken.As<Tokens::Id>().value);
-    Consume<Tokens::Id>();
+    std::vector<std::string> result;
+    result.push_back(Consume<Tokens::Id>().value);
     while (m_CurrentToken.Is<Tokens::Dot>())
     {
         Consume<Tokens::Dot>();
-        Token token = m_CurrentToken;
-        Consume<Tokens::Id>();
-        result.push_back(token.As<Tokens::Id>().value);
+        result.push_back(Consume<Tokens::Id>().value);
+    }
+
+    // self itself, a field of it or a call of one of its methods, as
+    // self.name( is
+    if (m_Impurities && result[0] == "self")
+    {
+        std::string use = result.size() > 1 ? "self." + result[1] : "self";
+        if (result.size() == 2 && m_CurrentToken.Is<Tokens::Lparen>())
+            use += "()";
+        m_Impurities->selfUses.insert(std::move(use));
     }
     return result;
 }
@@ -248,6 +636,23 @@ std::unique_ptr<AST::Node> Parser::ParseLogicalExpr()
     return node;
 }
 
+// Right-hand sides of assignments and returns, where a, b is a tuple
+std::unique_ptr<AST::Node> Parser::ParseTupleOrLogicalExpr()
+{
+    std::unique_ptr<AST::Node> node = ParseLogicalExpr();
+    if (!m_CurrentToken.Is<Tokens::Comma>())
+        return node;
+
+    std::vector<std::unique_ptr<AST::Node>> items;
+    items.push_back(std::move(node));
+    while (m_CurrentToken.Is<Tokens::Comma>())
+    {
+        Consume<Tokens::Comma>();
+        items.push_back(ParseLogicalExpr());
+    }
+    return std::make_unique<AST::TupleLiteral>(std::move(items));
+}
+
 std::unique_ptr<AST::Node> Parser::ParseAndTest()
 {
     std::unique_ptr<AST::Node> node = ParseNotTest();
@@ -279,32 +684,43 @@ std::unique_ptr<AST::Node> Parser::ParseComparison()
     if (m_CurrentToken.Is<Tokens::Less>())
     {
         Consume<Tokens::Less>();
-        node = std::make_unique<AST::Comparison>(Runtime::Less, std::move(node), ParseExpr());
+        node = std::make_unique<AST::Comparison>(Runtime::CompareOp::Less, std::move(node), ParseExpr());
     }
     else if (m_CurrentToken.Is<Tokens::LessOrEq>())
     {
         Consume<Tokens::LessOrEq>();
-        node = std::make_unique<AST::Comparison>(Runtime::LessOrEqual, std::move(node), ParseExpr());
+        node = std::make_unique<AST::Comparison>(Runtime::CompareOp::LessOrEqual, std::move(node), ParseExpr());
     }
     else if (m_CurrentToken.Is<Tokens::Greater>())
     {
         Consume<Tokens::Greater>();
-        node = std::make_unique<AST::Comparison>(Runtime::Greater, std::move(node), ParseExpr());
+        node = std::make_unique<AST::Comparison>(Runtime::CompareOp::Greater, std::move(node), ParseExpr());
     }
     else if (m_CurrentToken.Is<Tokens::GreaterOrEq>())
     {
         Consume<Tokens::GreaterOrEq>();
-        node = std::make_unique<AST::Comparison>(Runtime::GreaterOrEqual, std::move(node), ParseExpr());
+        node = std::make_unique<AST::Comparison>(Runtime::CompareOp::GreaterOrEqual, std::move(node), ParseExpr());
     }
     else if (m_CurrentToken.Is<Tokens::Eq>())
     {
         Consume<Tokens::Eq>();
-        node = std::make_unique<AST::Comparison>(Runtime::Equal, std::move(node), ParseExpr());
+        node = std::make_unique<AST::Comparison>(Runtime::CompareOp::Equal, std::move(node), ParseExpr());
     }
     else if (m_CurrentToken.Is<Tokens::NotEq>())
     {
         Consume<Tokens::NotEq>();
-        node = std::make_unique<AST::Comparison>(Runtime::NotEqual, std::move(node), ParseExpr());
+        node = std::make_unique<AST::Comparison>(Runtime::CompareOp::NotEqual, std::move(node), ParseExpr());
+    }
+    else if (m_CurrentToken.Is<Tokens::In>())
+    {
+        Consume<Tokens::In>();
+        node = std::make_unique<AST::Membership>(std::move(node), ParseExpr());
+    }
+    else if (m_CurrentToken.Is<Tokens::Not>())
+    {
+        Consume<Tokens::Not>();
+        Consume<Tokens::In>();
+        node = std::make_unique<AST::Not>(std::make_unique<AST::Membership>(std::move(node), ParseExpr()));
     }
 
     return node;
@@ -353,7 +769,6 @@ std::unique_ptr<AST::Node> Parser::ParseTerm()
 std::unique_ptr<AST::Node> Parser::ParseFactor()
 {
     std::unique_ptr<AST::Node> node;
-    Token token = m_CurrentToken;
     if (m_CurrentToken.Is<Tokens::Plus>())
     {
         Consume<Tokens::Plus>();
@@ -366,19 +781,213 @@ std::unique_ptr<AST::Node> Parser::ParseFactor()
     }
     else if (m_CurrentToken.Is<Tokens::Integer>())
     {
-        Consume<Tokens::Integer>();
-        node = std::make_unique<AST::NumericConst>(token.As<Tokens::Integer>().value);
+        node = std::make_unique<AST::NumericConst>(Consume<Tokens::Integer>().value);
+    }
+    else if (m_CurrentToken.Is<Tokens::Float>())
+    {
+        node = std::make_unique<AST::FloatConst>(Consume<Tokens::Float>().value);
+    }
+    else if (m_CurrentToken.Is<Tokens::LongInteger>())
+    {
+        node = std::make_unique<AST::BigIntConst>(BigInteger::FromString(Consume<Tokens::LongInteger>().value));
+    }
+    else if (m_CurrentToken.Is<Tokens::String>())
+    {
+        node = std::make_unique<AST::StringConst>(Consume<Tokens::String>().value);
+    }
+    else if (m_CurrentToken.Is<Tokens::FormatString>())
+    {
+        node = ParseFormatString();
+    }
+    else if (m_CurrentToken.Is<Tokens::True>())
+    {
+        Consume<Tokens::True>();
+        node = std::make_unique<AST::BoolConst>(true);
+    }
+    else if (m_CurrentToken.Is<Tokens::False>())
+    {
+        Consume<Tokens::False>();
+        node = std::make_unique<AST::BoolConst>(false);
+    }
+    else if (m_CurrentToken.Is<Tokens::None>())
+    {
+        Consume<Tokens::None>();
+        node = std::make_unique<AST::None>();
     }
     else if (m_CurrentToken.Is<Tokens::Lparen>())
     {
+        // (expr), or a tuple: (), (a,), (a, b)
         Consume<Tokens::Lparen>();
-        node = ParseExpr();
+        if (m_CurrentToken.Is<Tokens::Rparen>())
+        {
+            node = std::make_unique<AST::TupleLiteral>(std::vector<std::unique_ptr<AST::Node>>());
+        }
+        else
+        {
+            node = ParseLogicalExpr();
+            if (m_CurrentToken.Is<Tokens::Comma>())
+            {
+                std::vector<std::unique_ptr<AST::Node>> items;
+                items.push_back(std::move(node));
+                while (m_CurrentToken.Is<Tokens::Comma>())
+                {
+                    Consume<Tokens::Comma>();
+                    if (m_CurrentToken.Is<Tokens::Rparen>())
+                        break;
+                    items.push_back(ParseLogicalExpr());
+                }
+                node = std::make_unique<AST::TupleLiteral>(std::move(items));
+            }
+        }
         Consume<Tokens::Rparen>();
     }
+    else if (m_CurrentToken.Is<Tokens::Lbracket>())
+    {
+        Consume<Tokens::Lbracket>();
+        std::vector<std::unique_ptr<AST::Node>> items;
+        if (!m_CurrentToken.Is<Tokens::Rbracket>())
+        {
+            items = ParseLogicalExprList();
+        }
+        Consume<Tokens::Rbracket>();
+        node = std::make_unique<AST::ListLiteral>(std::move(items));
+    }
+    else if (m_CurrentToken.Is<Tokens::Lbrace>())
+    {
+        Consume<Tokens::Lbrace>();
+        std::vector<AST::DictLiteral::Item> items;
+        while (!m_CurrentToken.Is<Tokens::Rbrace>())
+        {
+            std::unique_ptr<AST::Node> key = ParseLogicalExpr();
+            Consume<Tokens::Colon>();
+            items.emplace_back(std::move(key), ParseLogicalExpr());
+
+            if (!m_CurrentToken.Is<Tokens::Comma>())
+                break;
+
+            Consume<Tokens::Comma>();
+        }
+        Consume<Tokens::Rbrace>();
+        node = std::make_unique<AST::DictLiteral>(std::move(items));
+    }
     else
     {
-        node = std::make_unique<AST::VariableValue>(ParseDottedIds().back());
+        node = ParseNameOrCall(ParseDottedIds());
+    }
+
+    return ParsePostfix(std::move(node));
+}
+
+// A variable or a field of one, or a call of a function, class or method
+std::unique_ptr<AST::Node> Parser::ParseNameOrCall(std::vector<std::string> idList)
+{
+    if (!m_CurrentToken.Is<Tokens::Lparen>())
+        return std::make_unique<AST::VariableValue>(std::move(idList));
+
+    Consume<Tokens::Lparen>();
+    std::vector<std::unique_ptr<AST::Node>> args;
+    if (!m_CurrentToken.Is<Tokens::Rparen>())
+    {
+        args = ParseLogicalExprList();
+    }
+    Consume<Tokens::Rparen>();
+
+    std::string name = std::move(idList.back());
+    idList.pop_back();
+
+    if (!idList.empty())
+    {
+        return std::make_unique<AST::MethodCall>(
+            std::make_unique<AST::VariableValue>(std::move(idList)),
+            std::move(name),
+            std::move(args)
+        );
     }
+    return MakeCall(std::move(name), std::move(args));
+}
+
+// Subscripts, fields and method calls of any expression, like (a < b).sum()
+// or xs[0].name
+std::unique_ptr<AST::Node> Parser::ParsePostfix(std::unique_ptr<AST::Node> node)
+{
+    while (m_CurrentToken.Is<Tokens::Lbracket>() || m_CurrentToken.Is<Tokens::Dot>())
+    {
+        if (m_CurrentToken.Is<Tokens::Lbracket>())
+        {
+            node = ParseSubscript(std::move(node));
+            continue;
+        }
+
+        Consume<Tokens::Dot>();
+        std::string name = Consume<Tokens::Id>().value;
+        if (!m_CurrentToken.Is<Tokens::Lparen>())
+        {
+            node = std::make_unique<AST::FieldValue>(std::move(node), std::move(name));
+            continue;
+        }
 
+        Consume<Tokens::Lparen>();
+        std::vector<std::unique_ptr<AST::Node>> args;
+        if (!m_CurrentToken.Is<Tokens::Rparen>())
+        {
+            args = ParseLogicalExprList();
+        }
+        Consume<Tokens::Rparen>();
+
+        node = std::make_unique<AST::MethodCall>(std::move(node), std::move(name), std::move(args));
+    }
     return node;
 }
+
+std::unique_ptr<AST::Node> Parser::ParseSubscript(std::unique_ptr<AST::Node> object)
+{
+    // object[index], or a slice object[begin:end] with optional bounds
+    Consume<Tokens::Lbracket>();
+    std::unique_ptr<AST::Node> begin;
+    if (!m_CurrentToken.Is<Tokens::Colon>())
+    {
+        begin = ParseLogicalExpr();
+        if (m_CurrentToken.Is<Tokens::Rbracket>())
+        {
+            Consume<Tokens::Rbracket>();
+            return std::make_unique<AST::Subscript>(std::move(object), std::move(begin));
+        }
+    }
+
+    Consume<Tokens::Colon>();
+    std::unique_ptr<AST::Node> end;
+    if (!m_CurrentToken.Is<Tokens::Rbracket>())
+    {
+        end = ParseLogicalExpr();
+    }
+    Consume<Tokens::Rbracket>();
+    return std::make_unique<AST::Slice>(std::move(object), std::move(begin), std::move(end));
+}
+
+std::unique_ptr<AST::Node> Parser::ParseFormatString()
+{
+    Tokens::FormatString format = Consume<Tokens::FormatString>();
+
+    // Each hole is parsed from a lexer of its own, by this parser so that
+    // it sees the declared classes and functions
+    Lexer* lexer = m_Lexer;
+    Token next = std::move(m_CurrentToken);
+    std::vector<std::unique_ptr<AST::Node>> holes;
+
+    for (const std::string& source : format.holes)
+    {
+        std::istringstream input(source);
+        Lexer holeLexer(input);
+        m_Lexer = &holeLexer;
+        m_CurrentToken = holeLexer.GetNextToken();
+
+        holes.push_back(ParseLogicalExpr());
+        if (!m_CurrentToken.Is<Tokens::NewLine>() && !m_CurrentToken.Is<Tokens::Eof>())
+            throw std::runtime_error("Unexpected token in f-string expression " + source);
+    }
+
+    m_Lexer = lexer;
+    m_CurrentToken = std::move(next);
+    return std::make_unique<AST::FormatString>(std::move(format.literals), std::move(holes));
+}
+
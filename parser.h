@@ -1,4 +1,10 @@
+#pragma once
+
 #include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
 #include <vector>
 #include "lexer.h"
 #include "token.h"
@@ -8,12 +14,23 @@ class Parser
 {
 public:
     Parser(Lexer& lexer)
-        : m_Lexer(lexer), m_CurrentToken(m_Lexer.GetNextToken())
+        : m_Lexer(&lexer), m_CurrentToken(m_Lexer->GetNextToken())
     {
     }
 
     std::unique_ptr<AST::Node> ParseProgram();
 
+    // Classes and functions the program defines itself, once it's parsed
+    const Runtime::Closure& GetDefinedClasses() const
+    {
+        return m_DefinedClasses;
+    }
+
+    const Runtime::Closure& GetDefinedFunctions() const
+    {
+        return m_DefinedFunctions;
+    }
+
 private:
 
     std::unique_ptr<AST::Node> ParseExpr();
@@ -23,27 +40,72 @@ private:
     std::unique_ptr<AST::Node> ParseSimpleStatement();
     std::unique_ptr<AST::Node> ParseAssignmentStatementOrCall();
     std::vector<std::unique_ptr<AST::Node>> ParseLogicalExprList();
-    std::vector<Runtime::Method> ParseMethods();
+    std::vector<Runtime::Method> ParseMethods(const std::string& className);
     std::unique_ptr<AST::Node> ParseLogicalExpr();
+    std::unique_ptr<AST::Node> ParseTupleOrLogicalExpr();
     std::unique_ptr<AST::Node> ParseAndTest();
     std::unique_ptr<AST::Node> ParseNotTest();
     std::unique_ptr<AST::Node> ParseComparison();
     std::unique_ptr<AST::Node> ParseClassDefinition();
+    std::unique_ptr<AST::Node> ParseFunctionDefinition(std::optional<size_t> memoCapacity);
+    size_t ParseMemoize();
+    std::unique_ptr<AST::Node> ParseMemoizedBody(const std::string& name);
+    std::vector<std::string> ParseFormalParams();
+    std::unique_ptr<AST::Node> ParseCallableBody();
+    ObjectHolder DeclareFunction(const std::string& name);
+    std::unique_ptr<AST::Node> MakeCall(std::string name, std::vector<std::unique_ptr<AST::Node>> args);
+    std::unique_ptr<AST::Node> ParseNameOrCall(std::vector<std::string> idList);
+    std::unique_ptr<AST::Node> ParsePostfix(std::unique_ptr<AST::Node> node);
     std::unique_ptr<AST::Node> ParseCondition();
+    std::unique_ptr<AST::Node> ParseWhile();
+    std::unique_ptr<AST::Node> ParseFor();
+    std::unique_ptr<AST::Node> ParseTry();
+    std::unique_ptr<AST::Node> ParseImport();
+    std::unique_ptr<AST::Node> ParseLoopBody();
     std::unique_ptr<AST::Node> ParseBlock();
     std::vector<std::string> ParseDottedIds();
+    std::unique_ptr<AST::Node> ParseSubscript(std::unique_ptr<AST::Node> object);
+    std::unique_ptr<AST::Node> ParseFormatString();
 
+    // Moves the value out of the current token, so that names and literals
+    // aren't copied on their way to the AST
     template<typename T>
-    void Consume()
+    T Consume()
     {
-        if (m_CurrentToken.Is<T>())
-            m_CurrentToken = m_Lexer.GetNextToken();
-        else
+        if (!m_CurrentToken.Is<T>())
             throw std::runtime_error("Unxpected Token at line");
+
+        Token token = std::exchange(m_CurrentToken, m_Lexer->GetNextToken());
+        return std::move(token).Take<T>();
     }
 
 private:
-    Lexer& m_Lexer;
+    // Switched to the lexers of f-string holes while they are parsed
+    Lexer* m_Lexer;
     Token m_CurrentToken;
     Runtime::Closure m_DeclaredClasses;
+    // Builtin classes the program hasn't replaced with classes of its own
+    std::set<std::string> m_BuiltinClasses;
+    // Functions are declared by their first call or their definition,
+    // whichever comes first
+    Runtime::Closure m_DeclaredFunctions;
+    // The ones not imported, which importers of the program get
+    Runtime::Closure m_DefinedClasses;
+    Runtime::Closure m_DefinedFunctions;
+    int m_BlockDepth = 0;
+    // Number of loops around the statement being parsed, break and continue
+    // are only allowed inside of them
+    int m_LoopDepth = 0;
+    // Whether a method or function body is being parsed, and whether it yields
+    bool m_InCallable = false;
+    bool m_HasYield = false;
+    // What the body of a @memoize method or function depends on besides its
+    // arguments and instance, reported as warnings once the body is parsed
+    struct Impurities
+    {
+        // self, self.field and self.method() as they appear in the body
+        std::set<std::string> selfUses;
+        bool prints = false;
+    };
+    std::optional<Impurities> m_Impurities;
 };
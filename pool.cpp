@@ -0,0 +1,90 @@
+#include "pool.h"
+#include <algorithm>
+
+namespace Runtime {
+
+static constexpr size_t BlockAlignment = alignof(std::max_align_t);
+
+static std::vector<Pool*>& Pools()
+{
+    static std::vector<Pool*>* pools = new std::vector<Pool*>();
+    return *pools;
+}
+
+Pool::Pool(std::string name, size_t blockSize, size_t blocksPerChunk)
+    : m_Name(std::move(name))
+{
+    blockSize = std::max(blockSize, sizeof(FreeBlock));
+    m_Statistics.blockSize = (blockSize + BlockAlignment - 1) / BlockAlignment * BlockAlignment;
+    m_Statistics.blocksPerChunk = std::max<size_t>(blocksPerChunk, 1);
+    Pools().push_back(this);
+}
+
+void* Pool::Allocate()
+{
+    if (!m_FreeList)
+        Grow();
+
+    FreeBlock* block = m_FreeList;
+    m_FreeList = block->next;
+
+    m_Statistics.allocations++;
+    m_Statistics.live++;
+    m_Statistics.peak = std::max(m_Statistics.peak, m_Statistics.live);
+    return block;
+}
+
+void Pool::Deallocate(void* block)
+{
+    FreeBlock* freed = static_cast<FreeBlock*>(block);
+    freed->next = m_FreeList;
+    m_FreeList = freed;
+
+    m_Statistics.deallocations++;
+    m_Statistics.live--;
+}
+
+void Pool::SetBlocksPerChunk(size_t count)
+{
+    m_Statistics.blocksPerChunk = std::max<size_t>(count, 1);
+}
+
+void Pool::Grow()
+{
+    const size_t blockSize = m_Statistics.blockSize;
+    const size_t count = m_Statistics.blocksPerChunk;
+
+    std::byte* chunk = m_Chunks.emplace_back(new std::byte[blockSize * count]).get();
+    m_Statistics.chunks++;
+
+    // Thread the blocks so that they are handed out in address order
+    for (size_t i = count; i-- > 0; )
+    {
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + i * blockSize);
+        block->next = m_FreeList;
+        m_FreeList = block;
+    }
+}
+
+const std::vector<Pool*>& Pool::GetPools()
+{
+    return Pools();
+}
+
+void PrintPoolStatistics(std::ostream& os)
+{
+    os << "Pools" << '\n';
+    for (const Pool* pool : Pool::GetPools())
+    {
+        const PoolStatistics& stats = pool->GetStatistics();
+        os << pool->GetName() << ": "
+           << "block " << stats.blockSize << "B, "
+           << "chunks " << stats.chunks << " x " << stats.blocksPerChunk << ", "
+           << "allocations " << stats.allocations << ", "
+           << "deallocations " << stats.deallocations << ", "
+           << "live " << stats.live << ", "
+           << "peak " << stats.peak << '\n';
+    }
+}
+
+}
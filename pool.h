@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Runtime {
+
+struct PoolStatistics
+{
+    size_t blockSize = 0;
+    size_t blocksPerChunk = 0;
+    size_t chunks = 0;
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t live = 0;
+    size_t peak = 0;
+};
+
+// Free-list allocator of equally sized blocks carved out of bigger chunks.
+// Freed blocks are reused before a new chunk is requested and chunks are
+// never given back, so a pool only grows up to the peak number of objects.
+class Pool
+{
+public:
+    Pool(std::string name, size_t blockSize, size_t blocksPerChunk);
+
+    void* Allocate();
+    void Deallocate(void* block);
+
+    void SetBlocksPerChunk(size_t count);
+
+    const std::string& GetName() const
+    {
+        return m_Name;
+    }
+
+    const PoolStatistics& GetStatistics() const
+    {
+        return m_Statistics;
+    }
+
+    static const std::vector<Pool*>& GetPools();
+private:
+    void Grow();
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    std::string m_Name;
+    FreeBlock* m_FreeList = nullptr;
+    std::vector<std::unique_ptr<std::byte[]>> m_Chunks;
+    PoolStatistics m_Statistics;
+};
+
+// Objects of a type get their own pool when the type specializes the traits,
+// everything else goes to the global allocator.
+template <typename T>
+struct PoolTraits
+{
+    static constexpr bool Pooled = false;
+};
+
+// Allocator for std::allocate_shared. The shared pointer rebinds it to its
+// control block type, Tag keeps the runtime type the pool is chosen by.
+template <typename T, typename Tag = T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind
+    {
+        using other = PoolAllocator<U, Tag>;
+    };
+
+    PoolAllocator() = default;
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U, Tag>&) noexcept
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        if constexpr (PoolTraits<Tag>::Pooled)
+        {
+            if (n == 1)
+                return static_cast<T*>(GetPool().Allocate());
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept
+    {
+        if constexpr (PoolTraits<Tag>::Pooled)
+        {
+            if (n == 1)
+                return GetPool().Deallocate(p);
+        }
+        ::operator delete(p);
+    }
+
+    static Pool& GetPool()
+    {
+        // Never destroyed, objects may outlive static destructors
+        static Pool* pool = new Pool(PoolTraits<Tag>::Name, sizeof(T), PoolTraits<Tag>::BlocksPerChunk);
+        return *pool;
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U, Tag>&) const noexcept
+    {
+        return true;
+    }
+};
+
+void PrintPoolStatistics(std::ostream& os);
+
+}
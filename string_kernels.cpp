@@ -0,0 +1,247 @@
+#include "string_kernels.h"
+#include "array_kernels.h"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_AVX2_KERNELS
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+namespace Runtime::Kernels {
+
+namespace {
+
+// Whether the needle occurs at a position whose first and last characters
+// are already known to match
+bool MatchesInside(const char* candidate, std::string_view needle)
+{
+    return needle.size() < 3 || std::memcmp(candidate + 1, needle.data() + 1, needle.size() - 2) == 0;
+}
+
+// Lower to upper case is a flip of bit 5 of the bytes from 'a' to 'z', upper
+// to lower the same for the bytes from 'A' to 'Z'
+void ScalarChangeCase(const char* in, char* out, size_t n, size_t start, char first)
+{
+    for (size_t i = start; i < n; i++)
+    {
+        char c = in[i];
+        out[i] = static_cast<unsigned char>(c - first) < 26 ? c ^ 0x20 : c;
+    }
+}
+
+#ifdef __SSE2__
+namespace Sse2 {
+
+constexpr size_t Width = 16;
+
+// Candidates are the positions where both the first and the last character
+// of the needle match, only those are compared in full
+size_t Find(std::string_view haystack, std::string_view needle, size_t& i)
+{
+    const char* s = haystack.data();
+    size_t m = needle.size();
+    __m128i first = _mm_set1_epi8(needle.front());
+    __m128i last = _mm_set1_epi8(needle.back());
+
+    for (; i + m - 1 + Width <= haystack.size(); i += Width)
+    {
+        __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + m - 1));
+        uint32_t mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last)));
+
+        for (; mask; mask &= mask - 1)
+        {
+            size_t position = i + std::countr_zero(mask);
+            if (MatchesInside(s + position, needle))
+                return position;
+        }
+    }
+    return NotFound;
+}
+
+size_t CountByte(std::string_view haystack, char c, size_t& i)
+{
+    __m128i value = _mm_set1_epi8(c);
+    size_t count = 0;
+
+    for (; i + Width <= haystack.size(); i += Width)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack.data() + i));
+        count += std::popcount(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, value))));
+    }
+    return count;
+}
+
+// Adding 128 - first moves the letters to the bottom of the signed range,
+// so one signed comparison tells them apart
+size_t ChangeCase(const char* in, char* out, size_t n, char first)
+{
+    __m128i shift = _mm_set1_epi8(static_cast<char>(128 - first));
+    __m128i limit = _mm_set1_epi8(-128 + 26);
+    __m128i flip = _mm_set1_epi8(0x20);
+
+    size_t i = 0;
+    for (; i + Width <= n; i += Width)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i letters = _mm_cmplt_epi8(_mm_add_epi8(block, shift), limit);
+        __m128i result = _mm_xor_si128(block, _mm_and_si128(letters, flip));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+    }
+    return i;
+}
+
+}
+#endif
+
+#ifdef HAVE_AVX2_KERNELS
+namespace Avx2 {
+
+constexpr size_t Width = 32;
+
+AVX2_TARGET size_t Find(std::string_view haystack, std::string_view needle, size_t& i)
+{
+    const char* s = haystack.data();
+    size_t m = needle.size();
+    __m256i first = _mm256_set1_epi8(needle.front());
+    __m256i last = _mm256_set1_epi8(needle.back());
+
+    for (; i + m - 1 + Width <= haystack.size(); i += Width)
+    {
+        __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i + m - 1));
+        uint32_t mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(head, first), _mm256_cmpeq_epi8(tail, last)));
+
+        for (; mask; mask &= mask - 1)
+        {
+            size_t position = i + std::countr_zero(mask);
+            if (MatchesInside(s + position, needle))
+                return position;
+        }
+    }
+    return NotFound;
+}
+
+AVX2_TARGET size_t CountByte(std::string_view haystack, char c, size_t& i)
+{
+    __m256i value = _mm256_set1_epi8(c);
+    size_t count = 0;
+
+    for (; i + Width <= haystack.size(); i += Width)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack.data() + i));
+        count += std::popcount(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, value))));
+    }
+    return count;
+}
+
+AVX2_TARGET size_t ChangeCase(const char* in, char* out, size_t n, char first)
+{
+    __m256i shift = _mm256_set1_epi8(static_cast<char>(128 - first));
+    __m256i limit = _mm256_set1_epi8(-128 + 26);
+    __m256i flip = _mm256_set1_epi8(0x20);
+
+    size_t i = 0;
+    for (; i + Width <= n; i += Width)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i letters = _mm256_cmpgt_epi8(limit, _mm256_add_epi8(block, shift));
+        __m256i result = _mm256_xor_si256(block, _mm256_and_si256(letters, flip));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), result);
+    }
+    return i;
+}
+
+}
+#endif
+
+void ChangeCase(const char* in, char* out, size_t n, char first)
+{
+    size_t done = 0;
+#ifdef HAVE_AVX2_KERNELS
+    if (HasAvx2())
+        done = Avx2::ChangeCase(in, out, n, first);
+#endif
+#ifdef __SSE2__
+    if (!HasAvx2())
+        done = Sse2::ChangeCase(in, out, n, first);
+#endif
+    ScalarChangeCase(in, out, n, done, first);
+}
+
+}
+
+size_t Find(std::string_view haystack, std::string_view needle, size_t start)
+{
+    if (start > haystack.size())
+        return NotFound;
+
+    if (needle.empty())
+        return start;
+
+    size_t i = start;
+    size_t position = NotFound;
+#ifdef HAVE_AVX2_KERNELS
+    if (HasAvx2())
+        position = Avx2::Find(haystack, needle, i);
+#endif
+#ifdef __SSE2__
+    if (!HasAvx2())
+        position = Sse2::Find(haystack, needle, i);
+#endif
+
+    if (position != NotFound)
+        return position;
+
+    // The vector loops stop where a load would pass the end
+    return haystack.find(needle, i);
+}
+
+size_t Count(std::string_view haystack, std::string_view needle)
+{
+    if (needle.empty())
+        return haystack.size() + 1;
+
+    if (needle.size() > 1)
+    {
+        size_t count = 0;
+        for (size_t i = Find(haystack, needle); i != NotFound; i = Find(haystack, needle, i + needle.size()))
+        {
+            count++;
+        }
+        return count;
+    }
+
+    size_t i = 0;
+    size_t count = 0;
+#ifdef HAVE_AVX2_KERNELS
+    if (HasAvx2())
+        count = Avx2::CountByte(haystack, needle.front(), i);
+#endif
+#ifdef __SSE2__
+    if (!HasAvx2())
+        count = Sse2::CountByte(haystack, needle.front(), i);
+#endif
+
+    for (; i < haystack.size(); i++)
+    {
+        count += haystack[i] == needle.front();
+    }
+    return count;
+}
+
+void ToUpper(const char* in, char* out, size_t n)
+{
+    ChangeCase(in, out, n, 'a');
+}
+
+void ToLower(const char* in, char* out, size_t n)
+{
+    ChangeCase(in, out, n, 'A');
+}
+
+}
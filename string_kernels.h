@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+// Search and case conversion kernels of strings. They use AVX2 when the CPU
+// supports it and SSE2 otherwise, which every x86-64 CPU has, and plain
+// loops elsewhere and for the tails shorter than a vector. Case conversion
+// only applies to ASCII letters, other bytes are kept as they are.
+namespace Runtime::Kernels {
+
+constexpr size_t NotFound = std::string_view::npos;
+
+// First occurrence of the needle at or after start
+size_t Find(std::string_view haystack, std::string_view needle, size_t start = 0);
+
+// Occurrences that don't overlap, an empty needle occurs between all the
+// characters and at both ends
+size_t Count(std::string_view haystack, std::string_view needle);
+
+void ToUpper(const char* in, char* out, size_t n);
+void ToLower(const char* in, char* out, size_t n);
+
+}
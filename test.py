@@ -1,4 +1,6 @@
 class Message:
-    def Say():
-        a = 10 == 10
-print('hello i\\\'m')
+  def Say():
+    a = 10 == 10
+    return a
+m = Message()
+print('hello i\\\'m', m.Say())
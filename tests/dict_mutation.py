@@ -0,0 +1,29 @@
+# A key whose __eq__ inserts into the dict it is looked up in, which
+# rehashes the table in the middle of the probe
+class Key:
+  def __init__(d, n):
+    self.d = d
+    self.n = n
+  def __hash__():
+    return 1
+  def __eq__(other):
+    for i in range(100, 140):
+      self.d[i] = i
+    return self.n == other.n
+d = {}
+a = Key(d, 1)
+b = Key(d, 1)
+d[a] = 5
+d[b] = 7
+print(d[a], d[100], d[139], len(d))
+class Clearing:
+  def __init__(d):
+    self.d = d
+  def __hash__():
+    self.d[200] = 200
+    return 2
+  def __eq__(other):
+    return False
+c = Clearing(d)
+d[c] = 1
+print(d[c], d[200], len(d))
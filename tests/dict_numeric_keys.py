@@ -0,0 +1,11 @@
+# Numbers equal by == are the same key whatever their types
+d = {1: 2, 1.0: 3, True: 4}
+print(d, d[1.0], d[True], len(d))
+print({0.0: 1, -0.0: 2, False: 3})
+big = 100000000000000000000
+e = {big: "big", 2.5: "float"}
+print(e[1e20], e[2.5], 2.5 in e, 3 in e)
+q = big / 100000000000000000
+f = {1000: "int"}
+print(f[q], f[1000.0])
+print(1 == 1.0, 1.0 in [1, 2], True in [1, 2], 2.5 in [1, 2], 1.0 in [1, "a"])
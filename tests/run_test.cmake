@@ -0,0 +1,12 @@
+# Runs a script with the interpreter and compares what it prints, errors
+# included, with the expected output next to it
+execute_process(
+    COMMAND ${INTERPRETER} ${SCRIPT}
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE output
+)
+file(READ ${EXPECTED} expected)
+
+if(NOT output STREQUAL expected)
+    message(FATAL_ERROR "${SCRIPT} printed:\n${output}\nexpected:\n${expected}")
+endif()
@@ -0,0 +1,6 @@
+# A chain that neither ends in a call nor is assigned to is rejected by the
+# parser, before anything runs
+xs = [[1]]
+xs[0].append(2)
+print(xs)
+xs[0]
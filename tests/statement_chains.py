@@ -0,0 +1,21 @@
+# Statements made of chains of subscripts, fields and calls: calls at the
+# end of a chain, and assignments to the last subscript or field of one
+class P:
+  def __init__():
+    self.items = [1]
+    self.x = 0
+  def get():
+    return self.items
+d = {"a": [1]}
+d["a"].append(2)
+xs = [[1], [5]]
+xs[0].append(2)
+a = P()
+a.get().append(3)
+ps = [P(), P()]
+ps[1].x = 7
+ps[1].items[0] = 9
+print(d, xs, a.items, ps[1].x, ps[1].items, ps[0].items[0], ps[1].get()[0])
+m = [[0, 0], [0, 0]]
+m[1][0] = 4
+print(m)
@@ -6,11 +6,23 @@ std::ostream& operator<<(std::ostream& os, const Token& token)
                                             os << #type << " {" << ptr->value << "}"
 
     PRINT_TOKEN_WITH_VALUE(Tokens::Integer);
+    PRINT_TOKEN_WITH_VALUE(Tokens::LongInteger);
+    PRINT_TOKEN_WITH_VALUE(Tokens::Float);
     PRINT_TOKEN_WITH_VALUE(Tokens::Id);
     PRINT_TOKEN_WITH_VALUE(Tokens::String);
 
     #undef PRINT_TOKEN_WITH_VALUE
 
+    if (const Tokens::FormatString* ptr = token.TryAs<Tokens::FormatString>())
+    {
+        os << "Tokens::FormatString {" << ptr->literals.front();
+        for (size_t i = 0; i < ptr->holes.size(); i++)
+        {
+            os << '{' << ptr->holes[i] << '}' << ptr->literals[i + 1];
+        }
+        os << '}';
+    }
+
     #define PRINT_TOKEN(type) if (token.Is<type>()) \
                                 os << #type
 
@@ -22,6 +34,10 @@ std::ostream& operator<<(std::ostream& os, const Token& token)
     PRINT_TOKEN(Tokens::Div);
     PRINT_TOKEN(Tokens::Lparen);
     PRINT_TOKEN(Tokens::Rparen);
+    PRINT_TOKEN(Tokens::Lbracket);
+    PRINT_TOKEN(Tokens::Rbracket);
+    PRINT_TOKEN(Tokens::Lbrace);
+    PRINT_TOKEN(Tokens::Rbrace);
     PRINT_TOKEN(Tokens::Assign);
     PRINT_TOKEN(Tokens::Indent);
     PRINT_TOKEN(Tokens::Dedent);
@@ -29,11 +45,22 @@ std::ostream& operator<<(std::ostream& os, const Token& token)
     PRINT_TOKEN(Tokens::Class);
     PRINT_TOKEN(Tokens::Def);
     PRINT_TOKEN(Tokens::Return);
+    PRINT_TOKEN(Tokens::Yield);
+    PRINT_TOKEN(Tokens::Try);
+    PRINT_TOKEN(Tokens::Except);
+    PRINT_TOKEN(Tokens::Raise);
+    PRINT_TOKEN(Tokens::As);
+    PRINT_TOKEN(Tokens::Import);
     PRINT_TOKEN(Tokens::If);
     PRINT_TOKEN(Tokens::Else);
+    PRINT_TOKEN(Tokens::While);
+    PRINT_TOKEN(Tokens::For);
+    PRINT_TOKEN(Tokens::Break);
+    PRINT_TOKEN(Tokens::Continue);
     PRINT_TOKEN(Tokens::And);
     PRINT_TOKEN(Tokens::Or);
     PRINT_TOKEN(Tokens::Not);
+    PRINT_TOKEN(Tokens::In);
     PRINT_TOKEN(Tokens::Eq);
     PRINT_TOKEN(Tokens::NotEq);
     PRINT_TOKEN(Tokens::LessOrEq);
@@ -46,6 +73,7 @@ std::ostream& operator<<(std::ostream& os, const Token& token)
     PRINT_TOKEN(Tokens::Colon);
     PRINT_TOKEN(Tokens::Comma);
     PRINT_TOKEN(Tokens::Dot);
+    PRINT_TOKEN(Tokens::At);
 
     #undef PRINT_TOKEN
 
@@ -58,13 +86,26 @@ bool operator==(const Token& lhs, const Token& rhs)
         return false;
 
     if (lhs.Is<Tokens::Id>())
-        return lhs.As<Tokens::Id>().value == lhs.As<Tokens::Id>().value;
+        return lhs.As<Tokens::Id>().value == rhs.As<Tokens::Id>().value;
 
     if (lhs.Is<Tokens::Integer>())
-        return lhs.As<Tokens::Integer>().value == lhs.As<Tokens::Integer>().value;
+        return lhs.As<Tokens::Integer>().value == rhs.As<Tokens::Integer>().value;
+
+    if (lhs.Is<Tokens::LongInteger>())
+        return lhs.As<Tokens::LongInteger>().value == rhs.As<Tokens::LongInteger>().value;
+
+    if (lhs.Is<Tokens::Float>())
+        return lhs.As<Tokens::Float>().value == rhs.As<Tokens::Float>().value;
 
     if (lhs.Is<Tokens::String>())
-        return lhs.As<Tokens::String>().value == lhs.As<Tokens::String>().value;
+        return lhs.As<Tokens::String>().value == rhs.As<Tokens::String>().value;
+
+    if (lhs.Is<Tokens::FormatString>())
+    {
+        const Tokens::FormatString& left = lhs.As<Tokens::FormatString>();
+        const Tokens::FormatString& right = rhs.As<Tokens::FormatString>();
+        return left.literals == right.literals && left.holes == right.holes;
+    }
 
     return true;
 }
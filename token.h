@@ -2,6 +2,7 @@
 
 #include <variant>
 #include <string>
+#include <vector>
 #include <ostream>
 
 namespace Tokens
@@ -11,6 +12,17 @@ namespace Tokens
         int value;
     };
 
+    struct Float
+    {
+        double value;
+    };
+
+    // Integer literal that doesn't fit into int
+    struct LongInteger
+    {
+        std::string value;
+    };
+
     struct Id
     {
         std::string value;
@@ -21,6 +33,13 @@ namespace Tokens
         std::string value;
     };
 
+    // f"..." split at its {} holes, there is one more literal than holes
+    struct FormatString
+    {
+        std::vector<std::string> literals;
+        std::vector<std::string> holes;
+    };
+
     struct Eof{};
     struct NewLine{};
     struct Plus{};
@@ -29,6 +48,10 @@ namespace Tokens
     struct Div{};
     struct Lparen{};
     struct Rparen{};
+    struct Lbracket{};
+    struct Rbracket{};
+    struct Lbrace{};
+    struct Rbrace{};
     struct Assign{};
     struct Indent{};
     struct Dedent{};
@@ -36,11 +59,22 @@ namespace Tokens
     struct Class{};
     struct Def{};
     struct Return{};
+    struct Yield{};
+    struct Try{};
+    struct Except{};
+    struct Raise{};
+    struct As{};
+    struct Import{};
     struct If{};
     struct Else{};
+    struct While{};
+    struct For{};
+    struct Break{};
+    struct Continue{};
     struct And{};
     struct Or{};
     struct Not{};
+    struct In{};
     struct Eq{};
     struct NotEq{};
     struct LessOrEq{};
@@ -53,6 +87,7 @@ namespace Tokens
     struct Colon{};
     struct Comma{};
     struct Dot{};
+    struct At{};
 }
 
 using TokenType = std::variant<
@@ -63,22 +98,40 @@ using TokenType = std::variant<
     Tokens::Mul,
     Tokens::Div,
     Tokens::Integer,
+    Tokens::LongInteger,
+    Tokens::Float,
     Tokens::Lparen,
     Tokens::Rparen,
+    Tokens::Lbracket,
+    Tokens::Rbracket,
+    Tokens::Lbrace,
+    Tokens::Rbrace,
     Tokens::Id,
     Tokens::Assign,
     Tokens::String,
+    Tokens::FormatString,
     Tokens::Indent,
     Tokens::Dedent,
     Tokens::Print,
     Tokens::Class,
     Tokens::Def,
     Tokens::Return,
+    Tokens::Yield,
+    Tokens::Try,
+    Tokens::Except,
+    Tokens::Raise,
+    Tokens::As,
+    Tokens::Import,
     Tokens::If,
     Tokens::Else,
+    Tokens::While,
+    Tokens::For,
+    Tokens::Break,
+    Tokens::Continue,
     Tokens::And,
     Tokens::Or,
     Tokens::Not,
+    Tokens::In,
     Tokens::Eq,
     Tokens::NotEq,
     Tokens::LessOrEq,
@@ -90,7 +143,8 @@ using TokenType = std::variant<
     Tokens::False,
     Tokens::Colon,
     Tokens::Comma,
-    Tokens::Dot
+    Tokens::Dot,
+    Tokens::At
 >;
 
 class Token
@@ -113,6 +167,12 @@ public:
         return std::get<T>(m_Type);
     }
 
+    template<typename T>
+    T Take() &&
+    {
+        return std::get<T>(std::move(m_Type));
+    }
+
     template<typename T>
     const T* TryAs() const
     {